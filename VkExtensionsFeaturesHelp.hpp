@@ -2,7 +2,7 @@
 VkExtensionsFeaturesHelp - Small header-only C++ library that helps to initialize Vulkan instance and device object
 
 Author:  Adam Sawicki - https://asawicki.info - adam__DELETE__@asawicki.info
-Version: 1.1.0, 2021-04-08
+Version: 2.0.0, 2026-10-16
 License: MIT
 
 Documentation: see README.md and other .md files in the repository or online on GitHub:
@@ -10,6 +10,24 @@ https://github.com/sawickiap/VkExtensionsFeaturesHelp
 
 # Version history
 
+Version 2.0.0, 2026-10-16
+
+- Added IDs of extensions, layers, and feature structures usable at compile time,
+  with overloads of all query methods taking them.
+- Added VulkanFunctions to call Vulkan through dynamically fetched pointers.
+- Added macros VKEFH_*_EXTENSION_REQUIRES, VKEFH_*_EXTENSION_PROMOTED,
+  VKEFH_*_FEATURE_STRUCT_REQUIRES, VKEFH_DEVICE_EXTENSION_REQUIRED,
+  VKEFH_DEVICE_FEATURE_REQUIRED to the definition file.
+- Added device property structures, queue family planning, minimal enable mode,
+  capability set operations, and DeviceCapabilities snapshot.
+- Added PhysicalDeviceSelector, capability cache, PipelineCacheLoader,
+  DriverQuirkTable, and loading capabilities from Vulkan Profiles JSON.
+- Added EnumerateAsync, PrepareRecreation, and GetCapabilityFingerprint.
+- Added optional instrumentation and support for multiple definition sets
+  in separate namespaces.
+- PrepareCreation now returns VkResult. pNext chains of feature structures
+  are updated incrementally.
+
 Version 1.1.0, 2021-04-08
 
 - Added macro VKEFH_ASSERT that can be defined before including this file to use
@@ -41,11 +59,101 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
-#pragma once
+/*
+This file includes itself with VKEFH_EXPAND_DEFINITION_FILE defined to expand the definition file
+at each place where a list of items is needed. The includer defines only the macros it uses.
+The others expand to nothing. All of them are undefined afterwards.
+*/
+#ifdef VKEFH_EXPAND_DEFINITION_FILE
+#ifndef VKEFH_INSTANCE_EXTENSION
+    #define VKEFH_INSTANCE_EXTENSION(extensionName)
+#endif
+#ifndef VKEFH_INSTANCE_LAYER
+    #define VKEFH_INSTANCE_LAYER(layerName)
+#endif
+#ifndef VKEFH_INSTANCE_FEATURE_STRUCT
+    #define VKEFH_INSTANCE_FEATURE_STRUCT(structName, sType)
+#endif
+#ifndef VKEFH_DEVICE_EXTENSION
+    #define VKEFH_DEVICE_EXTENSION(extensionName)
+#endif
+#ifndef VKEFH_DEVICE_FEATURE_STRUCT
+    #define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)
+#endif
+#ifndef VKEFH_INSTANCE_EXTENSION_REQUIRES
+    #define VKEFH_INSTANCE_EXTENSION_REQUIRES(extensionName, requiredExtensionName)
+#endif
+#ifndef VKEFH_INSTANCE_EXTENSION_PROMOTED
+    #define VKEFH_INSTANCE_EXTENSION_PROMOTED(extensionName, apiVersion)
+#endif
+#ifndef VKEFH_DEVICE_EXTENSION_REQUIRES
+    #define VKEFH_DEVICE_EXTENSION_REQUIRES(extensionName, requiredExtensionName)
+#endif
+#ifndef VKEFH_DEVICE_EXTENSION_PROMOTED
+    #define VKEFH_DEVICE_EXTENSION_PROMOTED(extensionName, apiVersion)
+#endif
+#ifndef VKEFH_DEVICE_PROPERTY_STRUCT
+    #define VKEFH_DEVICE_PROPERTY_STRUCT(structName, sType)
+#endif
+#ifndef VKEFH_DEVICE_PROPERTY_STRUCT_REQUIRES
+    #define VKEFH_DEVICE_PROPERTY_STRUCT_REQUIRES(structName, extensionName, apiVersion)
+#endif
+#ifndef VKEFH_DEVICE_FEATURE_MEMBER
+    #define VKEFH_DEVICE_FEATURE_MEMBER(structName, memberName)
+#endif
+#ifndef VKEFH_INSTANCE_FEATURE_STRUCT_REQUIRES
+    #define VKEFH_INSTANCE_FEATURE_STRUCT_REQUIRES(structName, extensionName, apiVersion)
+#endif
+#ifndef VKEFH_DEVICE_FEATURE_STRUCT_REQUIRES
+    #define VKEFH_DEVICE_FEATURE_STRUCT_REQUIRES(structName, extensionName, apiVersion)
+#endif
+#ifndef VKEFH_DEVICE_EXTENSION_REQUIRED
+    #define VKEFH_DEVICE_EXTENSION_REQUIRED(extensionName)
+#endif
+#ifndef VKEFH_DEVICE_FEATURE_REQUIRED
+    #define VKEFH_DEVICE_FEATURE_REQUIRED(structName, memberName)
+#endif
+#ifndef VKEFH_DEVICE_EXTENSION_QUIRK
+    #define VKEFH_DEVICE_EXTENSION_QUIRK(vendorID, deviceID, minDriverVersion, maxDriverVersion, extensionName, action)
+#endif
+#ifndef VKEFH_DEVICE_FEATURE_QUIRK
+    #define VKEFH_DEVICE_FEATURE_QUIRK(vendorID, deviceID, minDriverVersion, maxDriverVersion, structName, memberName, action)
+#endif
+
+#include VKEFH_DEFINITION_FILE
+
+#undef VKEFH_INSTANCE_EXTENSION
+#undef VKEFH_INSTANCE_LAYER
+#undef VKEFH_INSTANCE_FEATURE_STRUCT
+#undef VKEFH_DEVICE_EXTENSION
+#undef VKEFH_DEVICE_FEATURE_STRUCT
+#undef VKEFH_INSTANCE_EXTENSION_REQUIRES
+#undef VKEFH_INSTANCE_EXTENSION_PROMOTED
+#undef VKEFH_DEVICE_EXTENSION_REQUIRES
+#undef VKEFH_DEVICE_EXTENSION_PROMOTED
+#undef VKEFH_DEVICE_PROPERTY_STRUCT
+#undef VKEFH_DEVICE_PROPERTY_STRUCT_REQUIRES
+#undef VKEFH_DEVICE_FEATURE_MEMBER
+#undef VKEFH_INSTANCE_FEATURE_STRUCT_REQUIRES
+#undef VKEFH_DEVICE_FEATURE_STRUCT_REQUIRES
+#undef VKEFH_DEVICE_EXTENSION_REQUIRED
+#undef VKEFH_DEVICE_FEATURE_REQUIRED
+#undef VKEFH_DEVICE_EXTENSION_QUIRK
+#undef VKEFH_DEVICE_FEATURE_QUIRK
+#undef VKEFH_EXPAND_DEFINITION_FILE
+
+#else // #ifdef VKEFH_EXPAND_DEFINITION_FILE
+
+#ifndef VKEFH_COMMON_INCLUDED
+#define VKEFH_COMMON_INCLUDED
 
 #include <vector>
+#include <array>
+#include <memory>
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <cstddef>
 
 // Define this macro before including this file to use your own assert.
 #ifndef VKEFH_ASSERT
@@ -53,9 +161,280 @@ SOFTWARE.
     #define VKEFH_ASSERT(expr) assert(expr)
 #endif
 
+/*
+Define this macro to 1 before including this file to enable features that use
+memory-mapped files, like the capability cache. They include <windows.h> on Windows
+or POSIX headers on other platforms.
+*/
+#ifndef VKEFH_USE_MAPPED_FILES
+    #define VKEFH_USE_MAPPED_FILES 0
+#endif
+
+/*
+Define this macro to 0 before including this file to stop the library from calling
+statically linked Vulkan functions like vkEnumerateInstanceExtensionProperties.
+Then you need to provide pointers to them using SetVulkanFunctions, e.g. fetched by
+ImportVulkanFunctions. It allows using the library with VK_NO_PROTOTYPES.
+*/
+#ifndef VKEFH_STATIC_VULKAN_FUNCTIONS
+    #define VKEFH_STATIC_VULKAN_FUNCTIONS 1
+#endif
+
+/*
+Define this macro to 0 before including this file to disable features that use threads:
+EnumerateAsync and parallel probing in PhysicalDeviceSelector, so <thread>, <future>,
+and <atomic> are not included. Then PhysicalDeviceSelector probes devices one by one.
+*/
+#ifndef VKEFH_USE_THREADS
+    #define VKEFH_USE_THREADS 1
+#endif
+
+/*
+Define this macro to 1 before including this file to record duration of each phase
+of initialization and numbers of items processed, retrievable using GetInstrumentation
+and exportable as JSON or Chrome trace events. When 0, it adds no code or data.
+*/
+#ifndef VKEFH_INSTRUMENTATION
+    #define VKEFH_INSTRUMENTATION 0
+#endif
+
+#if VKEFH_INSTRUMENTATION
+    #include <chrono>
+    #include <cstdio>
+    #include <cstdarg>
+#endif
+
+#if VKEFH_USE_THREADS
+    #include <thread>
+    #include <future>
+    #include <atomic>
+#endif
+
+#if VKEFH_USE_MAPPED_FILES
+    #include <cstdio>
+    #include <chrono>
+    #include <string>
+    #include <thread>
+    #ifdef _WIN32
+        #include <windows.h>
+    #else
+        #include <sys/mman.h>
+        #include <sys/stat.h>
+        #include <fcntl.h>
+        #include <unistd.h>
+    #endif
+#endif
+
 namespace VKEFH
 {
 
+// Roles of queues that can be requested using DeviceInitHelp::RequestQueue.
+enum class QueueRole : uint32_t
+{
+    Graphics,
+    // Compute queue that can run in parallel with graphics, preferably from a family without graphics.
+    AsyncCompute,
+    // Queue for uploads, preferably from a family dedicated to transfer.
+    Transfer,
+    // Queue that can present to the surface passed to DeviceInitHelp::PlanQueues.
+    Present,
+    Count
+};
+
+// What DeviceInitHelp::ApplyDriverQuirks does with an extension or feature matched by a driver quirk rule.
+enum class DriverQuirkAction : uint32_t
+{
+    // Treat as not supported.
+    Disable,
+    // Don't enable by default, but leave it possible to enable explicitly.
+    NotPreferred,
+};
+
+// Maximum number of queue families considered by DeviceInitHelp::PlanQueues.
+constexpr uint32_t MAX_QUEUE_FAMILY_COUNT = 32;
+
+// Identifies a physical device together with its driver. Filled by DeviceInitHelp::GetPhysicalDeviceIdentity.
+struct DeviceIdentity
+{
+    uint32_t m_VendorID;
+    uint32_t m_DeviceID;
+    uint32_t m_DriverVersion;
+    uint32_t m_ApiVersion;
+    uint8_t m_DeviceUUID[VK_UUID_SIZE];
+    uint8_t m_PipelineCacheUUID[VK_UUID_SIZE];
+};
+
+// Value of an ID that doesn't correspond to any item specified in VkExtensionsFeatures.inl.
+constexpr uint32_t INVALID_ID = UINT32_MAX;
+
+constexpr bool StringsEqual(const char* lhs, const char* rhs)
+{
+    return *lhs == *rhs && (*lhs == '\0' || StringsEqual(lhs + 1, rhs + 1));
+}
+
+constexpr uint32_t FindNameInSecondHalf(uint32_t firstHalfResult, const char* const* names, const char* name, uint32_t middle, uint32_t last);
+
+// Searches names[first..last) by splitting the range in halves, to keep recursion shallow in constant expressions.
+constexpr uint32_t FindName(const char* const* names, const char* name, uint32_t first, uint32_t last)
+{
+    return last - first == 0 ? INVALID_ID :
+        last - first == 1 ? (StringsEqual(names[first], name) ? first : INVALID_ID) :
+        FindNameInSecondHalf(FindName(names, name, first, first + (last - first) / 2),
+            names, name, first + (last - first) / 2, last);
+}
+constexpr uint32_t FindNameInSecondHalf(uint32_t firstHalfResult, const char* const* names, const char* name, uint32_t middle, uint32_t last)
+{
+    return firstHalfResult != INVALID_ID ? firstHalfResult : FindName(names, name, middle, last);
+}
+
+// Pointers to Vulkan functions used by the library.
+struct VulkanFunctions
+{
+    PFN_vkEnumerateInstanceExtensionProperties vkEnumerateInstanceExtensionProperties;
+    PFN_vkEnumerateInstanceLayerProperties vkEnumerateInstanceLayerProperties;
+    PFN_vkEnumerateDeviceExtensionProperties vkEnumerateDeviceExtensionProperties;
+    PFN_vkGetPhysicalDeviceFeatures2 vkGetPhysicalDeviceFeatures2;
+    PFN_vkGetPhysicalDeviceProperties2 vkGetPhysicalDeviceProperties2;
+    PFN_vkGetPhysicalDeviceQueueFamilyProperties vkGetPhysicalDeviceQueueFamilyProperties;
+    PFN_vkGetPhysicalDeviceSurfaceSupportKHR vkGetPhysicalDeviceSurfaceSupportKHR;
+};
+
+/*
+Fills members of functions that are null using given vkGetInstanceProcAddr.
+Pass instance = VK_NULL_HANDLE to fetch only functions needed by InstanceInitHelp.
+Functions that are promoted to core Vulkan 1.1 are also searched under their KHR names.
+*/
+inline void ImportVulkanFunctions(VulkanFunctions& functions, PFN_vkGetInstanceProcAddr getInstanceProcAddr, VkInstance instance)
+{
+    VKEFH_ASSERT(getInstanceProcAddr);
+    if(functions.vkEnumerateInstanceExtensionProperties == nullptr)
+        functions.vkEnumerateInstanceExtensionProperties = (PFN_vkEnumerateInstanceExtensionProperties)
+            getInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceExtensionProperties");
+    if(functions.vkEnumerateInstanceLayerProperties == nullptr)
+        functions.vkEnumerateInstanceLayerProperties = (PFN_vkEnumerateInstanceLayerProperties)
+            getInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceLayerProperties");
+    if(instance == VK_NULL_HANDLE)
+        return;
+    if(functions.vkEnumerateDeviceExtensionProperties == nullptr)
+        functions.vkEnumerateDeviceExtensionProperties = (PFN_vkEnumerateDeviceExtensionProperties)
+            getInstanceProcAddr(instance, "vkEnumerateDeviceExtensionProperties");
+    if(functions.vkGetPhysicalDeviceFeatures2 == nullptr)
+        functions.vkGetPhysicalDeviceFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)
+            getInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2");
+    if(functions.vkGetPhysicalDeviceFeatures2 == nullptr)
+        functions.vkGetPhysicalDeviceFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2)
+            getInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR");
+    if(functions.vkGetPhysicalDeviceProperties2 == nullptr)
+        functions.vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2)
+            getInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2");
+    if(functions.vkGetPhysicalDeviceProperties2 == nullptr)
+        functions.vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2)
+            getInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR");
+    if(functions.vkGetPhysicalDeviceQueueFamilyProperties == nullptr)
+        functions.vkGetPhysicalDeviceQueueFamilyProperties = (PFN_vkGetPhysicalDeviceQueueFamilyProperties)
+            getInstanceProcAddr(instance, "vkGetPhysicalDeviceQueueFamilyProperties");
+    if(functions.vkGetPhysicalDeviceSurfaceSupportKHR == nullptr)
+        functions.vkGetPhysicalDeviceSurfaceSupportKHR = (PFN_vkGetPhysicalDeviceSurfaceSupportKHR)
+            getInstanceProcAddr(instance, "vkGetPhysicalDeviceSurfaceSupportKHR");
+}
+
+// FNV-1a hash of a null-terminated string.
+inline uint32_t HashString(const char* str)
+{
+    uint32_t hash = 2166136261u;
+    for(; *str != '\0'; ++str)
+    {
+        hash ^= (uint8_t)*str;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// FNV-1a 64-bit hash of a block of memory. Pass result of a previous call as hash to continue hashing.
+inline uint64_t HashBytes64(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for(size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/*
+Fast non-cryptographic hash of a sequence of 64-bit values, mixing one value per multiplication.
+Pass result of a previous call as hash to continue hashing, then pass the result through FinalizeHash64.
+It depends only on the values, not on the platform.
+*/
+inline uint64_t HashWord64(uint64_t word, uint64_t hash = 0x9E3779B97F4A7C15ull)
+{
+    hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 29);
+}
+// Packs VkBool32 values into bits, 64 per word, and hashes them using HashWord64.
+inline uint64_t HashBools64(const VkBool32* bools, size_t count, uint64_t hash)
+{
+    for(size_t first = 0; first < count; first += 64)
+    {
+        const size_t end = std::min<size_t>(count, first + 64);
+        uint64_t word = 0;
+        for(size_t i = first; i < end; ++i)
+            word |= (uint64_t)(bools[i] != VK_FALSE) << (i - first);
+        hash = HashWord64(word, hash);
+    }
+    return hash;
+}
+// Final mixing step of MurmurHash3, so that every bit of the input affects all bits of the result.
+inline uint64_t FinalizeHash64(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Smallest power of 2 that is at least twice the count.
+constexpr uint32_t GetHashTableSize(uint32_t count, uint32_t size = 1)
+{
+    return size >= count * 2 ? size : GetHashTableSize(count, size * 2);
+}
+
+template<size_t... Indices> struct IndexSequence { };
+template<size_t Count, size_t... Indices> struct MakeIndexSequence : MakeIndexSequence<Count - 1, Count - 1, Indices...> { };
+template<size_t... Indices> struct MakeIndexSequence<0, Indices...> { typedef IndexSequence<Indices...> Type; };
+
+// Converts to the type of any member in aggregate initialization. Used only in unevaluated context.
+template<size_t Index> struct AnyMember { template<typename T> operator T() const; };
+
+// Returns true if T can be aggregate-initialized with that many values, false if it has fewer members.
+template<typename T, size_t... Indices>
+constexpr auto CanInitializeMembers(IndexSequence<Indices...>, int) -> decltype((void)T{AnyMember<Indices>()...}, true)
+{
+    return true;
+}
+template<typename T, typename Sequence>
+constexpr bool CanInitializeMembers(Sequence, long)
+{
+    return false;
+}
+
+/*
+Number of VkBool32 members of a feature structure after sType and pNext. Calculating it from the size alone
+would include trailing padding when the number of members is odd and pointers are 8 bytes.
+*/
+template<typename T>
+constexpr uint32_t GetFeatureBoolCount()
+{
+    return CanInitializeMembers<T>(typename MakeIndexSequence<2 + (sizeof(T) - sizeof(VkBaseInStructure)) / sizeof(VkBool32)>::Type(), 0) ?
+        uint32_t((sizeof(T) - sizeof(VkBaseInStructure)) / sizeof(VkBool32)) :
+        uint32_t((sizeof(T) - sizeof(VkBaseInStructure)) / sizeof(VkBool32) - 1);
+}
+
+// Fixed-capacity storage for items specified in VkExtensionsFeatures.inl, so it never allocates memory.
+template<uint32_t Count>
 class EnabledItemVector
 {
 public:
@@ -63,9 +442,29 @@ public:
     {
         const char* m_Name;
         bool m_Supported, m_Enabled;
+        // Vulkan version that made the item part of core API, or 0 if not promoted.
+        uint32_t m_PromotedVersion;
     };
-    std::vector<EnabledItem> m_Items;
-    std::vector<const char*> m_EnabledItemNames;
+    std::array<EnabledItem, Count> m_Items;
+    std::array<const char*, Count> m_EnabledItemNames;
+    uint32_t m_EnabledItemCount = 0;
+    // Set when enabled state of any item may have changed since last PrepareEnabled.
+    bool m_Dirty = true;
+
+    void Init(const char* const* names)
+    {
+        m_HashTable.fill(INVALID_ID);
+        for(uint32_t i = 0; i < Count; ++i)
+        {
+            VKEFH_ASSERT(Find(names[i]) == SIZE_MAX && "Items specified in VkExtensionsFeatures.inl must be unique.");
+            m_Items[i] = {names[i], false, false, 0};
+            m_ItemHashes[i] = HashString(names[i]);
+            uint32_t slot = m_ItemHashes[i] & (HASH_TABLE_SIZE - 1);
+            while(m_HashTable[slot] != INVALID_ID)
+                slot = (slot + 1) & (HASH_TABLE_SIZE - 1);
+            m_HashTable[slot] = i;
+        }
+    }
 
 	void Reset()
 	{
@@ -74,7 +473,8 @@ public:
 			m_Items[i].m_Supported = false;
 			m_Items[i].m_Enabled = false;
 		}
-		m_EnabledItemNames.clear();
+		m_EnabledItemCount = 0;
+		m_Dirty = true;
 	}
 
     bool IsSupported(const char* name) const
@@ -98,51 +498,262 @@ public:
         size_t index = Find(name);
         if(index != SIZE_MAX)
         {
-            if(enabled && m_Items[index].m_Supported)
-            {
-                m_Items[index].m_Enabled = true;
-                return true;
-            }
-            m_Items[index].m_Enabled = false;
-            return false;
+            return Enable((uint32_t)index, enabled);
         }
         VKEFH_ASSERT(0 && "You can enable only for items specified in VkExtensionsFeatures.inl.");
         return false;
     }
+    bool IsSupported(uint32_t index) const
+    {
+        VKEFH_ASSERT(index < m_Items.size() && "You can query only for items specified in VkExtensionsFeatures.inl.");
+        return m_Items[index].m_Supported;
+    }
+    bool IsEnabled(uint32_t index) const
+    {
+        VKEFH_ASSERT(index < m_Items.size() && "You can query only for items specified in VkExtensionsFeatures.inl.");
+        return m_Items[index].m_Enabled;
+    }
+    bool Enable(uint32_t index, bool enabled)
+    {
+        VKEFH_ASSERT(index < m_Items.size() && "You can enable only for items specified in VkExtensionsFeatures.inl.");
+        enabled = enabled && m_Items[index].m_Supported;
+        if(m_Items[index].m_Enabled != enabled)
+        {
+            m_Items[index].m_Enabled = enabled;
+            m_Dirty = true;
+        }
+        return enabled;
+    }
     void EnableAll(bool enabled)
     {
-        for(size_t i = 0, count = m_Items.size(); i < count; ++i)
+        for(uint32_t i = 0; i < Count; ++i)
         {
-            m_Items[i].m_Enabled = enabled && m_Items[i].m_Supported;
+            Enable(i, enabled);
         }
     }
-    void PrepareEnabled()
+    // Gathers names of enabled items, except those promoted to core in apiVersion or earlier.
+    void PrepareEnabled(uint32_t apiVersion = 0)
     {
-        m_EnabledItemNames.clear();
+        if(!m_Dirty)
+            return;
+        m_Dirty = false;
+        m_EnabledItemCount = 0;
         for(size_t i = 0, count = m_Items.size(); i < count; ++i)
         {
-            if(m_Items[i].m_Enabled)
+            if(m_Items[i].m_Enabled && (m_Items[i].m_PromotedVersion == 0 || m_Items[i].m_PromotedVersion > apiVersion))
             {
                 VKEFH_ASSERT(m_Items[i].m_Supported);
-                m_EnabledItemNames.push_back(m_Items[i].m_Name);
+                m_EnabledItemNames[m_EnabledItemCount++] = m_Items[i].m_Name;
             }
         }
     }
 
-private:
+    // Returns index of the item or SIZE_MAX if not found. Costs one hash of the name
+    // and, unless the hash collides, at most one strcmp.
     size_t Find(const char* name) const
     {
-        for(size_t i = 0, count = m_Items.size(); i < count; ++i)
+        const uint32_t hash = HashString(name);
+        const uint32_t mask = HASH_TABLE_SIZE - 1;
+        for(uint32_t slot = hash & mask; ; slot = (slot + 1) & mask)
+        {
+            const uint32_t index = m_HashTable[slot];
+            if(index == INVALID_ID)
+                return SIZE_MAX;
+            if(m_ItemHashes[index] == hash && strcmp(name, m_Items[index].m_Name) == 0)
+                return index;
+        }
+    }
+
+private:
+    static const uint32_t HASH_TABLE_SIZE = GetHashTableSize(Count);
+    // Open addressing hash table with linear probing. Contains indices into m_Items
+    // or INVALID_ID for empty slots. Its size is a power of 2, at least twice the item count.
+    std::array<uint32_t, HASH_TABLE_SIZE> m_HashTable;
+    std::array<uint32_t, Count> m_ItemHashes;
+};
+
+#if VKEFH_INSTRUMENTATION
+
+enum class InstrumentedPhase : uint32_t
+{
+    EnumerateLayers,
+    EnumerateExtensions,
+    GetPhysicalDeviceFeatures,
+    GetPhysicalDeviceProperties,
+    PrepareCreation,
+    Count
+};
+
+// Statistics of a single object of InstanceInitHelp or DeviceInitHelp, collected when VKEFH_INSTRUMENTATION is 1.
+class Instrumentation
+{
+public:
+    struct PhaseRecord
+    {
+        // Time of the last call, in nanoseconds of std::chrono::steady_clock.
+        uint64_t m_StartTime;
+        // Sum of durations of all calls, in nanoseconds.
+        uint64_t m_Duration;
+        uint32_t m_CallCount;
+    };
+    struct ItemCounts
+    {
+        // Items returned by Vulkan.
+        uint32_t m_Reported;
+        // Items specified in VkExtensionsFeatures.inl.
+        uint32_t m_Declared;
+        // Items specified in VkExtensionsFeatures.inl and returned by Vulkan, so supported.
+        uint32_t m_Matched;
+        // Names passed to creation by the last PrepareCreation.
+        uint32_t m_Enabled;
+    };
+
+    std::array<PhaseRecord, (size_t)InstrumentedPhase::Count> m_Phases = {};
+    ItemCounts m_Extensions = {};
+    ItemCounts m_Layers = {};
+    // Numbers of structures linked into the pNext chain for the query and for the creation.
+    uint32_t m_QueryChainLength = 0;
+    uint32_t m_CreationChainLength = 0;
+
+    static const char* GetPhaseName(InstrumentedPhase phase)
+    {
+        static const char* const names[] = { "EnumerateLayers", "EnumerateExtensions",
+            "GetPhysicalDeviceFeatures", "GetPhysicalDeviceProperties", "PrepareCreation" };
+        static_assert(sizeof(names) / sizeof(names[0]) == (size_t)InstrumentedPhase::Count, "Names don't match InstrumentedPhase.");
+        return names[(size_t)phase];
+    }
+    static uint64_t GetTime()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*
+    Writes the statistics as a JSON object to buffer, like snprintf: the result is truncated and null-terminated
+    if it doesn't fit in bufferSize. Returns the length of the full result, not counting null terminator.
+    buffer can be null if bufferSize is 0.
+    */
+    size_t WriteJson(char* buffer, size_t bufferSize) const
+    {
+        Writer writer = {buffer, bufferSize, 0};
+        writer.Print("{\"Phases\":{");
+        for(uint32_t i = 0; i < (uint32_t)InstrumentedPhase::Count; ++i)
+        {
+            const PhaseRecord& rec = m_Phases[i];
+            writer.Print("%s\"%s\":{\"CallCount\":%u,\"StartTime\":%llu,\"Duration\":%llu}", i ? "," : "",
+                GetPhaseName((InstrumentedPhase)i), rec.m_CallCount, (unsigned long long)rec.m_StartTime, (unsigned long long)rec.m_Duration);
+        }
+        writer.Print("},");
+        WriteItemCounts(writer, "Extensions", m_Extensions);
+        writer.Print(",");
+        WriteItemCounts(writer, "Layers", m_Layers);
+        writer.Print(",\"QueryChainLength\":%u,\"CreationChainLength\":%u}", m_QueryChainLength, m_CreationChainLength);
+        return writer.m_Length;
+    }
+
+    /*
+    Writes the phases that were called as a JSON array of Chrome trace events, viewable in chrome://tracing
+    or Perfetto, with item counts as arguments. Works like WriteJson. Timestamps are in microseconds.
+    */
+    size_t WriteChromeTrace(char* buffer, size_t bufferSize, uint32_t processId = 0, uint32_t threadId = 0) const
+    {
+        Writer writer = {buffer, bufferSize, 0};
+        writer.Print("[");
+        bool first = true;
+        for(uint32_t i = 0; i < (uint32_t)InstrumentedPhase::Count; ++i)
         {
-            if(strcmp(name, m_Items[i].m_Name) == 0)
+            const PhaseRecord& rec = m_Phases[i];
+            if(rec.m_CallCount == 0)
+                continue;
+            writer.Print("%s{\"name\":\"%s\",\"cat\":\"VKEFH\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%llu.%03u,\"args\":{",
+                first ? "" : ",", GetPhaseName((InstrumentedPhase)i), processId, threadId,
+                (unsigned long long)(rec.m_StartTime / 1000), (uint32_t)(rec.m_StartTime % 1000),
+                (unsigned long long)(rec.m_Duration / 1000), (uint32_t)(rec.m_Duration % 1000));
+            switch((InstrumentedPhase)i)
             {
-                return i;
+            case InstrumentedPhase::EnumerateLayers:
+                WriteItemCounts(writer, "Layers", m_Layers);
+                break;
+            case InstrumentedPhase::EnumerateExtensions:
+                WriteItemCounts(writer, "Extensions", m_Extensions);
+                break;
+            case InstrumentedPhase::GetPhysicalDeviceFeatures:
+                writer.Print("\"QueryChainLength\":%u", m_QueryChainLength);
+                break;
+            case InstrumentedPhase::PrepareCreation:
+                writer.Print("\"EnabledExtensions\":%u,\"EnabledLayers\":%u,\"CreationChainLength\":%u",
+                    m_Extensions.m_Enabled, m_Layers.m_Enabled, m_CreationChainLength);
+                break;
+            default:
+                break;
             }
+            writer.Print("}}");
+            first = false;
         }
-        return SIZE_MAX;
+        writer.Print("]");
+        return writer.m_Length;
+    }
+
+private:
+    struct Writer
+    {
+        char* m_Buffer;
+        size_t m_BufferSize;
+        size_t m_Length;
+
+        void Print(const char* format, ...)
+        {
+            va_list args;
+            va_start(args, format);
+            const size_t offset = std::min(m_Length, m_BufferSize);
+            const int len = vsnprintf(m_Buffer ? m_Buffer + offset : nullptr, m_BufferSize - offset, format, args);
+            va_end(args);
+            if(len > 0)
+                m_Length += (size_t)len;
+        }
+    };
+
+    static void WriteItemCounts(Writer& writer, const char* name, const ItemCounts& counts)
+    {
+        writer.Print("\"%s\":{\"Reported\":%u,\"Declared\":%u,\"Matched\":%u,\"Enabled\":%u}",
+            name, counts.m_Reported, counts.m_Declared, counts.m_Matched, counts.m_Enabled);
+    }
+};
+
+// Measures duration of the enclosing scope as given phase.
+class InstrumentationScope
+{
+public:
+    InstrumentationScope(Instrumentation& instrumentation, InstrumentedPhase phase) :
+        m_Record(instrumentation.m_Phases[(size_t)phase]),
+        m_StartTime(Instrumentation::GetTime())
+    {
+    }
+    ~InstrumentationScope()
+    {
+        m_Record.m_StartTime = m_StartTime;
+        m_Record.m_Duration += Instrumentation::GetTime() - m_StartTime;
+        ++m_Record.m_CallCount;
     }
+    InstrumentationScope(const InstrumentationScope&) = delete;
+    InstrumentationScope& operator=(const InstrumentationScope&) = delete;
+
+private:
+    Instrumentation::PhaseRecord& m_Record;
+    const uint64_t m_StartTime;
 };
 
+#define VKEFH_INSTRUMENT_PHASE(phase) \
+    InstrumentationScope vkefhInstrumentationScope(m_Instrumentation, InstrumentedPhase::phase)
+
+#else
+
+#define VKEFH_INSTRUMENT_PHASE(phase)
+
+#endif // #if VKEFH_INSTRUMENTATION
+
+template<typename ExtensionId, typename FeatureStructId, uint32_t ExtensionCount, uint32_t FeatureStructCount,
+    uint32_t ExtensionDependencyCount>
 class InitHelpBase
 {
 public:
@@ -151,6 +762,33 @@ public:
 	InitHelpBase& operator=(const InitHelpBase&) = delete;
 	InitHelpBase& operator=(InitHelpBase&&) = delete;
 
+    /*
+    Sets pointers to Vulkan functions to be used instead of the statically linked ones.
+    Members that are null are left unchanged. Call it before any function that calls Vulkan.
+    */
+    void SetVulkanFunctions(const VulkanFunctions& functions)
+    {
+        if(functions.vkEnumerateInstanceExtensionProperties)
+            m_VulkanFunctions.vkEnumerateInstanceExtensionProperties = functions.vkEnumerateInstanceExtensionProperties;
+        if(functions.vkEnumerateInstanceLayerProperties)
+            m_VulkanFunctions.vkEnumerateInstanceLayerProperties = functions.vkEnumerateInstanceLayerProperties;
+        if(functions.vkEnumerateDeviceExtensionProperties)
+            m_VulkanFunctions.vkEnumerateDeviceExtensionProperties = functions.vkEnumerateDeviceExtensionProperties;
+        if(functions.vkGetPhysicalDeviceFeatures2)
+            m_VulkanFunctions.vkGetPhysicalDeviceFeatures2 = functions.vkGetPhysicalDeviceFeatures2;
+        if(functions.vkGetPhysicalDeviceProperties2)
+            m_VulkanFunctions.vkGetPhysicalDeviceProperties2 = functions.vkGetPhysicalDeviceProperties2;
+        if(functions.vkGetPhysicalDeviceQueueFamilyProperties)
+            m_VulkanFunctions.vkGetPhysicalDeviceQueueFamilyProperties = functions.vkGetPhysicalDeviceQueueFamilyProperties;
+        if(functions.vkGetPhysicalDeviceSurfaceSupportKHR)
+            m_VulkanFunctions.vkGetPhysicalDeviceSurfaceSupportKHR = functions.vkGetPhysicalDeviceSurfaceSupportKHR;
+    }
+    const VulkanFunctions& GetVulkanFunctions() const { return m_VulkanFunctions; }
+
+#if VKEFH_INSTRUMENTATION
+    const Instrumentation& GetInstrumentation() const { return m_Instrumentation; }
+#endif
+
     bool IsExtensionSupported(const char* extensionName) const
     {
         VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
@@ -164,7 +802,28 @@ public:
     bool EnableExtension(const char* extensionName, bool enabled)
     {
         VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
-        return m_Extensions.Enable(extensionName, enabled);
+        const bool result = m_Extensions.Enable(extensionName, enabled);
+        if(!enabled)
+            DisableExtensionsWithMissingDependencies();
+        return result;
+    }
+    bool IsExtensionSupported(ExtensionId extension) const
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        return m_Extensions.IsSupported((uint32_t)extension);
+    }
+    bool IsExtensionEnabled(ExtensionId extension) const
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        return m_Extensions.IsEnabled((uint32_t)extension);
+    }
+    bool EnableExtension(ExtensionId extension, bool enabled)
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        const bool result = m_Extensions.Enable((uint32_t)extension, enabled);
+        if(!enabled)
+            DisableExtensionsWithMissingDependencies();
+        return result;
     }
     void EnableAllExtensions(bool enabled)
     {
@@ -172,15 +831,62 @@ public:
         m_Extensions.EnableAll(enabled);
     }
 
+    /*
+    Sets Vulkan version that will be used, e.g. VK_API_VERSION_1_2. Extensions marked in VkExtensionsFeatures.inl
+    as promoted to core in this version or earlier are still reported as enabled, but their names are not passed
+    to creation, and extensions that require them don't need them to be enabled. Default is 0 - no extensions
+    are treated as promoted.
+    Feature and property structures marked in VkExtensionsFeatures.inl as core in some version are used if it is
+    not higher than this one. Until it is set, DeviceInitHelp uses apiVersion of the physical device instead.
+    */
+    void SetTargetApiVersion(uint32_t apiVersion)
+    {
+        if(apiVersion != m_TargetApiVersion)
+        {
+            m_TargetApiVersion = apiVersion;
+            m_Extensions.m_Dirty = true;
+        }
+    }
+    uint32_t GetTargetApiVersion() const { return m_TargetApiVersion; }
+
+    /*
+    Alternative to EnumerateExtensions that takes a list of extensions obtained in some other way,
+    e.g. recorded earlier or generated synthetically for testing and benchmarking.
+    */
+    void LoadExtensions(const VkExtensionProperties* extProps, size_t extPropCount)
+    {
+        VKEFH_ASSERT(!m_ExtensionsEnumerated && "You should call EnumerateExtensions only once.");
+        for(size_t extPropIndex = 0; extPropIndex < extPropCount; ++extPropIndex)
+        {
+            const size_t extIndex = m_Extensions.Find(extProps[extPropIndex].extensionName);
+            if(extIndex != SIZE_MAX)
+            {
+                m_Extensions.m_Items[extIndex].m_Supported = true;
+                m_Extensions.m_Items[extIndex].m_Enabled = true;
+            }
+        }
+        m_ExtensionsEnumerated = true;
+#if VKEFH_INSTRUMENTATION
+        m_Instrumentation.m_Extensions.m_Reported = (uint32_t)extPropCount;
+        m_Instrumentation.m_Extensions.m_Declared = ExtensionCount;
+        m_Instrumentation.m_Extensions.m_Matched = 0;
+        for(uint32_t i = 0; i < ExtensionCount; ++i)
+        {
+            if(m_Extensions.m_Items[i].m_Supported)
+                ++m_Instrumentation.m_Extensions.m_Matched;
+        }
+#endif
+    }
+
     uint32_t GetEnabledExtensionCount() const
     {
         VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
-        return (uint32_t)m_Extensions.m_EnabledItemNames.size();
+        return m_Extensions.m_EnabledItemCount;
     }
     const char* const* GetEnabledExtensionNames() const
     {
         VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
-        return !m_Extensions.m_EnabledItemNames.empty() ? m_Extensions.m_EnabledItemNames.data() : nullptr;
+        return m_Extensions.m_EnabledItemCount > 0 ? m_Extensions.m_EnabledItemNames.data() : nullptr;
     }
 
     bool IsFeatureStructEnabled(const char* structName) const
@@ -198,7 +904,7 @@ public:
         const size_t index = FindFeatureStruct(structName);
         if(index != SIZE_MAX)
         {
-            m_FeatureStructs[index].m_Enabled = enabled;
+            SetFeatureStructEnabled(index, enabled);
             return;
         }
         VKEFH_ASSERT(0 && "You can enable only feature structs specified in VkExtensionsFeatures.inl.");
@@ -219,69 +925,332 @@ public:
         const size_t index = FindFeatureStruct(sType);
         if(index != SIZE_MAX)
         {
-            m_FeatureStructs[index].m_Enabled = enabled;
+            SetFeatureStructEnabled(index, enabled);
             return;
         }
         VKEFH_ASSERT(0 && "You can enable only feature structs specified in VkExtensionsFeatures.inl.");
     }
 
+    bool IsFeatureStructEnabled(FeatureStructId structId) const
+    {
+        VKEFH_ASSERT((size_t)structId < m_FeatureStructs.size() && "You can query only for feature structs specified in VkExtensionsFeatures.inl.");
+        return m_FeatureStructs[(size_t)structId].m_Enabled;
+    }
+    void EnableFeatureStruct(FeatureStructId structId, bool enabled)
+    {
+        VKEFH_ASSERT((size_t)structId < m_FeatureStructs.size() && "You can enable only feature structs specified in VkExtensionsFeatures.inl.");
+        SetFeatureStructEnabled((size_t)structId, enabled);
+    }
+
     void EnableAllFeatureStructs(bool enabled)
     {
         for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
         {
-            m_FeatureStructs[i].m_Enabled = enabled;
+            SetFeatureStructEnabled(i, enabled);
         }
     }
 
 protected:
     bool m_ExtensionsEnumerated = false;
     bool m_CreationPrepared = false;
-    EnabledItemVector m_Extensions;
+    EnabledItemVector<ExtensionCount> m_Extensions;
+    uint32_t m_TargetApiVersion = 0;
+
+    struct ExtensionDependency
+    {
+        uint32_t m_Extension;
+        uint32_t m_RequiredExtension;
+    };
+    // Sorted so that every extension comes before extensions it requires, directly or indirectly.
+    std::array<ExtensionDependency, ExtensionDependencyCount> m_ExtensionDependencies;
+    uint32_t m_ExtensionDependencyCount = 0;
 
     struct FeatureStruct
     {
         const char* m_Name;
         VkStructureType m_sType;
         VkBaseInStructure* m_StructPtr;
+        // Structure linked into the pNext chain on behalf of this one. Normally equal to m_StructPtr.
+        VkBaseInStructure* m_LinkPtr;
+        uint32_t m_StructSize;
+        // Number of VkBool32 members after sType and pNext, without trailing padding. 0 for instance feature structures.
+        uint32_t m_BoolCount;
         bool m_Enabled;
+        // Whether the structure is currently linked into the pNext chain.
+        bool m_Linked;
+        // Whether the structure is in m_DirtyFeatureStructs.
+        bool m_Dirty;
+        // In minimal enable mode, whether no member is requested, so the structure is left out of the chain.
+        bool m_Empty;
+        // Whether requirements specified using VKEFH_*_FEATURE_STRUCT_REQUIRES are met. Recomputed before each chain build.
+        bool m_Available;
+        // Extension that needs to be supported to use the structure, or INVALID_ID.
+        uint32_t m_ExtensionIndex;
+        // Vulkan version that is enough to use the structure, or 0.
+        uint32_t m_ApiVersion;
     };
-    std::vector<FeatureStruct> m_FeatureStructs;
+    std::array<FeatureStruct, FeatureStructCount> m_FeatureStructs;
+    // Indices of structures whose IsFeatureStructLinkable may differ from m_Linked.
+    std::array<uint32_t, FeatureStructCount> m_DirtyFeatureStructs;
+    uint32_t m_DirtyFeatureStructCount = 0;
+
+    VulkanFunctions m_VulkanFunctions = {};
+
+#if VKEFH_INSTRUMENTATION
+    Instrumentation m_Instrumentation;
+
+    uint32_t CountLinkedFeatureStructs() const
+    {
+        uint32_t result = 0;
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            if(m_FeatureStructs[i].m_Linked)
+                ++result;
+        }
+        return result;
+    }
+#endif
 
-	InitHelpBase() { }
+	InitHelpBase()
+	{
+#if VKEFH_STATIC_VULKAN_FUNCTIONS
+		m_VulkanFunctions.vkEnumerateInstanceExtensionProperties = &::vkEnumerateInstanceExtensionProperties;
+		m_VulkanFunctions.vkEnumerateInstanceLayerProperties = &::vkEnumerateInstanceLayerProperties;
+		m_VulkanFunctions.vkEnumerateDeviceExtensionProperties = &::vkEnumerateDeviceExtensionProperties;
+		m_VulkanFunctions.vkGetPhysicalDeviceFeatures2 = &::vkGetPhysicalDeviceFeatures2;
+		m_VulkanFunctions.vkGetPhysicalDeviceProperties2 = &::vkGetPhysicalDeviceProperties2;
+		m_VulkanFunctions.vkGetPhysicalDeviceQueueFamilyProperties = &::vkGetPhysicalDeviceQueueFamilyProperties;
+		m_VulkanFunctions.vkGetPhysicalDeviceSurfaceSupportKHR = &::vkGetPhysicalDeviceSurfaceSupportKHR;
+#endif
+	}
 
 	void Reset()
 	{
 		m_ExtensionsEnumerated = false;
 		m_CreationPrepared = false;
 		m_Extensions.Reset();
+		m_TargetApiVersion = 0;
 		for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+		{
 			m_FeatureStructs[i].m_Enabled = true;
+			m_FeatureStructs[i].m_Available = true;
+		}
+		ResetFeatureChain();
 	}
 
-	void LoadExtensions(const VkExtensionProperties* extProps, size_t extPropCount)
+    // Sets whether the structure has no requested members. Next UpdateFeatureChain leaves empty structures out of the chain.
+    void SetFeatureStructEmpty(size_t index, bool empty)
     {
-        VKEFH_ASSERT(!m_ExtensionsEnumerated && "You should call EnumerateExtensions only once.");
-        for(size_t extPropIndex = 0; extPropIndex < extPropCount; ++extPropIndex)
+        m_FeatureStructs[index].m_Empty = empty;
+        MarkFeatureStructDirty(index);
+    }
+
+    // Forgets the current pNext chain, so all enabled structures get linked by next UpdateFeatureChain.
+    // Call it after filling m_FeatureStructs and whenever the head of the chain is cleared.
+    void ResetFeatureChain()
+    {
+        m_DirtyFeatureStructCount = 0;
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            m_FeatureStructs[i].m_Linked = false;
+            m_FeatureStructs[i].m_Dirty = false;
+            SetFeatureStructEnabled(i, m_FeatureStructs[i].m_Enabled);
+        }
+    }
+
+    /*
+    Brings the pNext chain starting at head up to date with the enabled state of feature structures.
+    Only structures enabled or disabled since the last call are spliced in or out, so it costs nothing
+    when nothing changed. The chain keeps structures in order of descending index.
+    */
+    void UpdateFeatureChain(void*& head)
+    {
+        for(uint32_t dirtyIndex = 0; dirtyIndex < m_DirtyFeatureStructCount; ++dirtyIndex)
         {
-            for(size_t extIndex = 0, extCount = m_Extensions.m_Items.size(); extIndex < extCount; ++extIndex)
+            const size_t structIndex = m_DirtyFeatureStructs[dirtyIndex];
+            FeatureStruct& featureStruct = m_FeatureStructs[structIndex];
+            featureStruct.m_Dirty = false;
+            const bool linkable = IsFeatureStructLinkable(featureStruct);
+            if(linkable == featureStruct.m_Linked)
+                continue;
+            VKEFH_ASSERT(featureStruct.m_LinkPtr->sType == featureStruct.m_sType);
+
+            // Predecessor is the nearest linked structure with higher index, or the head if there is none.
+            size_t prevIndex = structIndex + 1;
+            while(prevIndex < m_FeatureStructs.size() && !m_FeatureStructs[prevIndex].m_Linked)
+                ++prevIndex;
+            const bool hasPrev = prevIndex < m_FeatureStructs.size();
+            const VkBaseInStructure* next = hasPrev ?
+                m_FeatureStructs[prevIndex].m_LinkPtr->pNext : (const VkBaseInStructure*)head;
+
+            if(linkable)
             {
-                if(strcmp(extProps[extPropIndex].extensionName, m_Extensions.m_Items[extIndex].m_Name) == 0)
-                {
-                    m_Extensions.m_Items[extIndex].m_Supported = true;
-                    m_Extensions.m_Items[extIndex].m_Enabled = true;
-                }
+                featureStruct.m_LinkPtr->pNext = next;
+                next = featureStruct.m_LinkPtr;
+            }
+            else
+            {
+                VKEFH_ASSERT(next == featureStruct.m_LinkPtr && "pNext chain of feature structures was modified externally.");
+                next = featureStruct.m_LinkPtr->pNext;
             }
+            if(hasPrev)
+                m_FeatureStructs[prevIndex].m_LinkPtr->pNext = next;
+            else
+                head = (void*)next;
+            featureStruct.m_Linked = linkable;
         }
-        m_ExtensionsEnumerated = true;
+        m_DirtyFeatureStructCount = 0;
     }
 
     void PrepareEnabledExtensionNames()
     {
         VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
-        m_Extensions.PrepareEnabled();
+        if(m_Extensions.m_Dirty)
+        {
+            EnableExtensionDependencies();
+            DisableExtensionsWithMissingDependencies();
+        }
+        m_Extensions.PrepareEnabled(m_TargetApiVersion);
+    }
+
+    // Called for VKEFH_*_EXTENSION_REQUIRES and VKEFH_*_EXTENSION_PROMOTED while constructing the object.
+    void AddExtensionDependency(const char* extensionName, const char* requiredExtensionName)
+    {
+        const size_t extIndex = m_Extensions.Find(extensionName);
+        const size_t requiredExtIndex = m_Extensions.Find(requiredExtensionName);
+        VKEFH_ASSERT(extIndex != SIZE_MAX && requiredExtIndex != SIZE_MAX &&
+            "Extensions used in VKEFH_*_EXTENSION_REQUIRES must be specified in VkExtensionsFeatures.inl.");
+        if(extIndex == SIZE_MAX || requiredExtIndex == SIZE_MAX)
+            return;
+        m_ExtensionDependencies[m_ExtensionDependencyCount++] = {(uint32_t)extIndex, (uint32_t)requiredExtIndex};
+    }
+    void SetExtensionPromotedVersion(const char* extensionName, uint32_t apiVersion)
+    {
+        const size_t extIndex = m_Extensions.Find(extensionName);
+        VKEFH_ASSERT(extIndex != SIZE_MAX &&
+            "Extensions used in VKEFH_*_EXTENSION_PROMOTED must be specified in VkExtensionsFeatures.inl.");
+        if(extIndex == SIZE_MAX)
+            return;
+        m_Extensions.m_Items[extIndex].m_PromotedVersion = apiVersion;
+    }
+    // Called for VKEFH_*_FEATURE_STRUCT_REQUIRES while constructing the object.
+    void SetFeatureStructRequirement(FeatureStructId structId, const char* extensionName, uint32_t apiVersion)
+    {
+        FeatureStruct& featureStruct = m_FeatureStructs[(size_t)structId];
+        if(extensionName != nullptr)
+        {
+            const size_t extIndex = m_Extensions.Find(extensionName);
+            VKEFH_ASSERT(extIndex != SIZE_MAX &&
+                "Extensions used in VKEFH_*_FEATURE_STRUCT_REQUIRES must be specified in VkExtensionsFeatures.inl.");
+            featureStruct.m_ExtensionIndex = (uint32_t)extIndex;
+        }
+        featureStruct.m_ApiVersion = apiVersion;
+    }
+
+    /*
+    Recomputes which feature structures have their requirements specified using VKEFH_*_FEATURE_STRUCT_REQUIRES met.
+    Structures that don't are left out of the pNext chain, but stay enabled. For creation, the extension needs to be
+    enabled or promoted to the target API version. Otherwise it only needs to be supported, which is enough to query
+    the structure. apiVersion is the version that decides about structures that are part of core API.
+    */
+    void UpdateAvailableFeatureStructs(bool forCreation, uint32_t apiVersion)
+    {
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            FeatureStruct& featureStruct = m_FeatureStructs[i];
+            if(featureStruct.m_ExtensionIndex == INVALID_ID && featureStruct.m_ApiVersion == 0)
+                continue;
+            const bool extensionAvailable = featureStruct.m_ExtensionIndex != INVALID_ID &&
+                (forCreation ? IsExtensionAvailable(featureStruct.m_ExtensionIndex) : m_Extensions.IsSupported(featureStruct.m_ExtensionIndex));
+            const bool available = extensionAvailable || (featureStruct.m_ApiVersion != 0 && featureStruct.m_ApiVersion <= apiVersion);
+            if(available != featureStruct.m_Available)
+            {
+                featureStruct.m_Available = available;
+                MarkFeatureStructDirty(i);
+            }
+        }
+    }
+    // Sorts m_ExtensionDependencies topologically, by the length of the longest chain of requirements.
+    void SortExtensionDependencies()
+    {
+        // Checking the template argument too keeps GCC from warning about std::sort on an empty array.
+        if(ExtensionDependencyCount < 2 || m_ExtensionDependencyCount < 2)
+            return;
+        std::array<uint32_t, ExtensionCount> depths;
+        depths.fill(0);
+        for(uint32_t iteration = 0; ; ++iteration)
+        {
+            bool changed = false;
+            for(size_t i = 0; i < m_ExtensionDependencyCount; ++i)
+            {
+                const ExtensionDependency& dep = m_ExtensionDependencies[i];
+                if(depths[dep.m_Extension] <= depths[dep.m_RequiredExtension])
+                {
+                    depths[dep.m_Extension] = depths[dep.m_RequiredExtension] + 1;
+                    changed = true;
+                }
+            }
+            if(!changed)
+                break;
+            if(iteration >= ExtensionCount)
+            {
+                VKEFH_ASSERT(0 && "Dependencies between extensions specified in VkExtensionsFeatures.inl must not form a cycle.");
+                break;
+            }
+        }
+        std::sort(m_ExtensionDependencies.begin(), m_ExtensionDependencies.begin() + m_ExtensionDependencyCount,
+            [&depths](const ExtensionDependency& lhs, const ExtensionDependency& rhs)
+            {
+                return depths[lhs.m_Extension] > depths[rhs.m_Extension];
+            });
     }
 
 private:
+    bool IsExtensionAvailable(uint32_t extIndex) const
+    {
+        const auto& item = m_Extensions.m_Items[extIndex];
+        return item.m_Enabled || (item.m_PromotedVersion != 0 && item.m_PromotedVersion <= m_TargetApiVersion);
+    }
+    // Enables all extensions required by enabled extensions, if supported, in a single pass in topological order.
+    void EnableExtensionDependencies()
+    {
+        for(size_t i = 0; i < m_ExtensionDependencyCount; ++i)
+        {
+            const ExtensionDependency& dep = m_ExtensionDependencies[i];
+            if(m_Extensions.m_Items[dep.m_Extension].m_Enabled && !IsExtensionAvailable(dep.m_RequiredExtension))
+                m_Extensions.Enable(dep.m_RequiredExtension, true);
+        }
+    }
+    // Disables extensions that require an extension that is not enabled, in a single pass in reverse topological order.
+    void DisableExtensionsWithMissingDependencies()
+    {
+        for(size_t i = m_ExtensionDependencyCount; i--; )
+        {
+            const ExtensionDependency& dep = m_ExtensionDependencies[i];
+            if(m_Extensions.m_Items[dep.m_Extension].m_Enabled && !IsExtensionAvailable(dep.m_RequiredExtension))
+                m_Extensions.Enable(dep.m_Extension, false);
+        }
+    }
+
+    void SetFeatureStructEnabled(size_t index, bool enabled)
+    {
+        m_FeatureStructs[index].m_Enabled = enabled;
+        MarkFeatureStructDirty(index);
+    }
+    void MarkFeatureStructDirty(size_t index)
+    {
+        FeatureStruct& featureStruct = m_FeatureStructs[index];
+        if(!featureStruct.m_Dirty && IsFeatureStructLinkable(featureStruct) != featureStruct.m_Linked)
+        {
+            featureStruct.m_Dirty = true;
+            m_DirtyFeatureStructs[m_DirtyFeatureStructCount++] = (uint32_t)index;
+        }
+    }
+    static bool IsFeatureStructLinkable(const FeatureStruct& featureStruct)
+    {
+        return featureStruct.m_Enabled && featureStruct.m_Available && !featureStruct.m_Empty;
+    }
+
     size_t FindFeatureStruct(const char* name) const
     {
         for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
@@ -306,316 +1275,2837 @@ private:
     }
 };
 
-class InstanceInitHelp : public InitHelpBase
+#if VKEFH_USE_MAPPED_FILES
+
+// Read-only view of an entire file mapped into memory.
+class MappedFile
+{
+public:
+    MappedFile() { }
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false if the file doesn't exist, is empty, or cannot be mapped.
+    bool Open(const char* filePath)
+    {
+        Close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size = {};
+        if(GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping != nullptr)
+            {
+                m_Data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if(m_Data != nullptr)
+                    m_Size = (size_t)size.QuadPart;
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        const int file = open(filePath, O_RDONLY);
+        if(file < 0)
+            return false;
+        struct stat fileStat = {};
+        if(fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+        {
+            void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if(data != MAP_FAILED)
+            {
+                m_Data = data;
+                m_Size = (size_t)fileStat.st_size;
+            }
+        }
+        close(file);
+#endif
+        return m_Data != nullptr;
+    }
+    void Close()
+    {
+        if(m_Data != nullptr)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(m_Data);
+#else
+            munmap(m_Data, m_Size);
+#endif
+            m_Data = nullptr;
+            m_Size = 0;
+        }
+    }
+
+    const void* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+
+private:
+    void* m_Data = nullptr;
+    size_t m_Size = 0;
+};
+
+/*
+Writes the file under a temporary name and then renames it to filePath, so that
+other processes reading the file concurrently never see it partially written.
+Optional data2 is written after data.
+*/
+inline bool WriteFileAtomically(const char* filePath, const void* data, size_t size,
+    const void* data2 = nullptr, size_t size2 = 0)
+{
+    char tmpFilePath[1024];
+    const unsigned long long uniqueSuffix = (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count() ^
+        (unsigned long long)(uintptr_t)&tmpFilePath;
+    const int tmpFilePathLen = snprintf(tmpFilePath, sizeof(tmpFilePath), "%s.%llx.tmp", filePath, uniqueSuffix);
+    if(tmpFilePathLen < 0 || (size_t)tmpFilePathLen >= sizeof(tmpFilePath))
+        return false;
+    FILE* file = fopen(tmpFilePath, "wb");
+    if(file == nullptr)
+        return false;
+    const bool written = fwrite(data, 1, size, file) == size &&
+        (size2 == 0 || fwrite(data2, 1, size2, file) == size2);
+    if(fclose(file) != 0 || !written)
+    {
+        remove(tmpFilePath);
+        return false;
+    }
+#ifdef _WIN32
+    const bool renamed = MoveFileExA(tmpFilePath, filePath, MOVEFILE_REPLACE_EXISTING) != FALSE;
+#else
+    const bool renamed = rename(tmpFilePath, filePath) == 0;
+#endif
+    if(!renamed)
+        remove(tmpFilePath);
+    return renamed;
+}
+
+#endif // #if VKEFH_USE_MAPPED_FILES
+
+/*
+Minimal forward-only JSON reader working directly on a buffer, without allocating memory.
+Strings are returned as pointers into the buffer, not unescaped. Values that are not needed
+are skipped by scanning for matching brackets, without parsing them.
+*/
+class JsonReader
+{
+public:
+    JsonReader(const char* json, size_t length) : m_Cur(json), m_End(json + length) { }
+
+    // Consumes opening brace of an object. Returns false if the next value is not an object.
+    bool BeginObject()
+    {
+        if(!Consume('{'))
+            return false;
+        m_First = true;
+        return true;
+    }
+    /*
+    Reads the next key of the current object, together with following colon. Returns false after
+    consuming closing brace of the object, or on error. Call it again only after reading or skipping the value.
+    */
+    bool NextKey(const char*& outKey, size_t& outKeyLength)
+    {
+        SkipWhitespace();
+        if(m_Cur < m_End && *m_Cur == '}')
+        {
+            ++m_Cur;
+            m_First = false;
+            return false;
+        }
+        if(!m_First && !Consume(','))
+            return Fail();
+        m_First = false;
+        bool escaped;
+        if(!ReadString(outKey, outKeyLength, escaped) || !Consume(':'))
+            return Fail();
+        return true;
+    }
+    bool IsObjectNext()
+    {
+        SkipWhitespace();
+        return m_Cur < m_End && *m_Cur == '{';
+    }
+    // Reads true or false, or a number treated as true if nonzero.
+    bool ReadBool(bool& outValue)
+    {
+        SkipWhitespace();
+        const char* const begin = m_Cur;
+        SkipLiteral();
+        const size_t length = (size_t)(m_Cur - begin);
+        if(length == 4 && memcmp(begin, "true", 4) == 0)
+            outValue = true;
+        else if(length == 5 && memcmp(begin, "false", 5) == 0)
+            outValue = false;
+        else if(length > 0 && (*begin == '-' || (*begin >= '0' && *begin <= '9')))
+        {
+            // Number is nonzero if it has a nonzero digit before the exponent.
+            outValue = false;
+            for(const char* p = begin; p < m_Cur && *p != 'e' && *p != 'E'; ++p)
+                outValue = outValue || (*p >= '1' && *p <= '9');
+        }
+        else
+            return Fail();
+        return true;
+    }
+    // Skips the next value of any type, including nested objects and arrays.
+    bool SkipValue()
+    {
+        SkipWhitespace();
+        if(m_Cur >= m_End)
+            return Fail();
+        if(*m_Cur != '{' && *m_Cur != '[')
+        {
+            if(*m_Cur == '"')
+            {
+                const char* str;
+                size_t length;
+                bool escaped;
+                return ReadString(str, length, escaped);
+            }
+            const char* const begin = m_Cur;
+            SkipLiteral();
+            return m_Cur != begin || Fail();
+        }
+        size_t depth = 0;
+        while(m_Cur < m_End)
+        {
+            const char c = *m_Cur;
+            if(c == '"')
+            {
+                const char* str;
+                size_t length;
+                bool escaped;
+                if(!ReadString(str, length, escaped))
+                    return false;
+                continue;
+            }
+            ++m_Cur;
+            if(c == '{' || c == '[')
+                ++depth;
+            else if((c == '}' || c == ']') && --depth == 0)
+            {
+                m_First = false;
+                return true;
+            }
+        }
+        return Fail();
+    }
+    // Reads a string. Returns pointer to its characters inside the JSON, without quotes. Escape sequences are not supported.
+    bool ReadString(const char*& outStr, size_t& outLength)
+    {
+        bool escaped;
+        if(!ReadString(outStr, outLength, escaped))
+            return false;
+        return !escaped || Fail();
+    }
+    // Reads a non-negative integer number that fits in 32 bits.
+    bool ReadUint32(uint32_t& outValue)
+    {
+        SkipWhitespace();
+        const char* const begin = m_Cur;
+        SkipLiteral();
+        if(m_Cur == begin)
+            return Fail();
+        uint64_t value = 0;
+        for(const char* p = begin; p < m_Cur; ++p)
+        {
+            if(*p < '0' || *p > '9')
+                return Fail();
+            value = value * 10 + (uint64_t)(*p - '0');
+            if(value > UINT32_MAX)
+                return Fail();
+        }
+        outValue = (uint32_t)value;
+        return true;
+    }
+    bool HasFailed() const { return m_Failed; }
+
+    // Compares string returned by NextKey with a null-terminated string.
+    static bool KeyEquals(const char* key, size_t keyLength, const char* str)
+    {
+        return strncmp(str, key, keyLength) == 0 && str[keyLength] == '\0';
+    }
+
+private:
+    const char* m_Cur;
+    const char* const m_End;
+    // Whether the current object had no keys read yet.
+    bool m_First = false;
+    bool m_Failed = false;
+
+    bool Fail()
+    {
+        m_Failed = true;
+        return false;
+    }
+    void SkipWhitespace()
+    {
+        while(m_Cur < m_End && (*m_Cur == ' ' || *m_Cur == '\t' || *m_Cur == '\n' || *m_Cur == '\r'))
+            ++m_Cur;
+    }
+    void SkipLiteral()
+    {
+        while(m_Cur < m_End && *m_Cur != ',' && *m_Cur != '}' && *m_Cur != ']' &&
+            *m_Cur != ' ' && *m_Cur != '\t' && *m_Cur != '\n' && *m_Cur != '\r')
+        {
+            ++m_Cur;
+        }
+    }
+    bool Consume(char c)
+    {
+        SkipWhitespace();
+        if(m_Cur >= m_End || *m_Cur != c)
+            return Fail();
+        ++m_Cur;
+        return true;
+    }
+    bool ReadString(const char*& outStr, size_t& outLength, bool& outEscaped)
+    {
+        if(!Consume('"'))
+            return false;
+        outStr = m_Cur;
+        outEscaped = false;
+        while(m_Cur < m_End && *m_Cur != '"')
+        {
+            if(*m_Cur == '\\')
+            {
+                outEscaped = true;
+                ++m_Cur;
+            }
+            ++m_Cur;
+        }
+        if(m_Cur >= m_End)
+            return Fail();
+        outLength = (size_t)(m_Cur - outStr);
+        ++m_Cur;
+        return true;
+    }
+};
+
+} // namespace VKEFH
+
+/*
+Creates DeviceFeatureBit for given structure and its member, e.g.:
+
+    VKEFH_FEATURE_BIT(VkPhysicalDeviceFeatures, samplerAnisotropy)
+    VKEFH_FEATURE_BIT(VkPhysicalDeviceMemoryPriorityFeaturesEXT, memoryPriority)
+
+Use VKEFH_SET_FEATURE_BIT for structures of a definition set defined in namespace other than VKEFH.
+*/
+#define VKEFH_SET_FEATURE_BIT(namespaceName, structName, memberName) \
+    (namespaceName::DeviceFeatureBit{namespaceName::DeviceFeatureStructId::structName, (uint32_t)offsetof(structName, memberName)})
+#define VKEFH_FEATURE_BIT(structName, memberName) VKEFH_SET_FEATURE_BIT(VKEFH, structName, memberName)
+
+#endif // #ifndef VKEFH_COMMON_INCLUDED
+
+/*
+Everything below depends on the definition file and is defined once for each definition set.
+By default, the set is loaded from file "VkExtensionsFeatures.inl" into namespace VKEFH.
+To use a different set in some part of the program, define macros VKEFH_DEFINITION_FILE and
+VKEFH_NAMESPACE before including this file, e.g.:
+
+    #define VKEFH_DEFINITION_FILE "ComputeExtensionsFeatures.inl"
+    #define VKEFH_NAMESPACE ComputeVkefh
+    #include "VkExtensionsFeaturesHelp.hpp"
+
+Classes and functions of the set are then available in that namespace, together with all members
+of namespace VKEFH. Both macros are undefined at the end of this file. Each named set must be
+included only once in a translation unit, so it is best to do it in a separate header with an include guard.
+*/
+#ifndef VKEFH_DEFINITION_FILE
+    #define VKEFH_DEFINITION_FILE "VkExtensionsFeatures.inl"
+#endif
+// Name of this file, to include itself. Define it before including this file if you rename it.
+#ifndef VKEFH_HEADER_FILE
+    #define VKEFH_HEADER_FILE "VkExtensionsFeaturesHelp.hpp"
+#endif
+
+#if defined(VKEFH_NAMESPACE)
+    #define VKEFH_DEFINE_SET 1
+    #define VKEFH_CUSTOM_NAMESPACE
+#elif !defined(VKEFH_DEFAULT_SET_INCLUDED)
+    #define VKEFH_DEFAULT_SET_INCLUDED
+    #define VKEFH_NAMESPACE VKEFH
+    #define VKEFH_DEFINE_SET 1
+#else
+    #define VKEFH_DEFINE_SET 0
+#endif
+
+#if VKEFH_DEFINE_SET
+
+namespace VKEFH_NAMESPACE
+{
+
+#ifdef VKEFH_CUSTOM_NAMESPACE
+using namespace VKEFH;
+#endif
+
+// Number of items of each kind specified in VkExtensionsFeatures.inl.
+constexpr uint32_t INSTANCE_EXTENSION_COUNT = 0
+#define VKEFH_INSTANCE_EXTENSION(extensionName)   + 1
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    ;
+constexpr uint32_t INSTANCE_LAYER_COUNT = 0
+#define VKEFH_INSTANCE_LAYER(layerName)   + 1
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    ;
+constexpr uint32_t INSTANCE_FEATURE_STRUCT_COUNT = 0
+#define VKEFH_INSTANCE_FEATURE_STRUCT(structName, sType)   + 1
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    ;
+constexpr uint32_t DEVICE_EXTENSION_COUNT = 0
+#define VKEFH_DEVICE_EXTENSION(extensionName)   + 1
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    ;
+constexpr uint32_t DEVICE_FEATURE_STRUCT_COUNT = 0
+#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)   + 1
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    ;
+constexpr uint32_t DEVICE_PROPERTY_STRUCT_COUNT = 0
+#define VKEFH_DEVICE_PROPERTY_STRUCT(structName, sType)   + 1
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    ;
+// Number of dependencies between extensions specified in VkExtensionsFeatures.inl.
+constexpr uint32_t INSTANCE_EXTENSION_DEPENDENCY_COUNT = 0
+#define VKEFH_INSTANCE_EXTENSION_REQUIRES(extensionName, requiredExtensionName)   + 1
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    ;
+constexpr uint32_t DEVICE_EXTENSION_DEPENDENCY_COUNT = 0
+#define VKEFH_DEVICE_EXTENSION_REQUIRES(extensionName, requiredExtensionName)   + 1
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    ;
+
+/*
+Strongly typed identifiers of items specified in VkExtensionsFeatures.inl.
+Their values are indices of the items in the order of their appearance in that file.
+Extensions and layers are identified by strings, so IDs for them are obtained using
+functions like GetDeviceExtensionId. Feature and property structures have named enumerators.
+*/
+enum class InstanceExtensionId : uint32_t { };
+enum class InstanceLayerId : uint32_t { };
+enum class DeviceExtensionId : uint32_t { };
+
+enum class InstanceFeatureStructId : uint32_t
+{
+#define VKEFH_INSTANCE_FEATURE_STRUCT(structName, sType)   structName,
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+};
+
+enum class DeviceFeatureStructId : uint32_t
+{
+#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)   structName,
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+    // Not a feature structure from the definition file, but the standard VkPhysicalDeviceFeatures.
+    // Its value is equal to DEVICE_FEATURE_STRUCT_COUNT.
+    VkPhysicalDeviceFeatures
+};
+
+enum class DevicePropertyStructId : uint32_t
+{
+#define VKEFH_DEVICE_PROPERTY_STRUCT(structName, sType)   structName,
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+};
+
+/*
+Identifies a single VkBool32 member of a device feature structure specified in
+VkExtensionsFeatures.inl or of the standard VkPhysicalDeviceFeatures.
+Create it using macro VKEFH_FEATURE_BIT or VKEFH_SET_FEATURE_BIT.
+*/
+struct DeviceFeatureBit
+{
+    DeviceFeatureStructId m_Struct;
+    // Offset of the member in bytes, from the beginning of the structure.
+    uint32_t m_Offset;
+};
+
+
+// Name of a VkBool32 member of a device feature structure, used to find it in capability files.
+struct FeatureMemberName
+{
+    const char* m_StructName;
+    const char* m_MemberName;
+    DeviceFeatureBit m_Bit;
+};
+
+// Names of all members of VkPhysicalDeviceFeatures, followed by members specified using VKEFH_DEVICE_FEATURE_MEMBER.
+// Template only to allow defining it in the header. Terminated with null.
+template<typename T = void>
+struct DefinitionFeatureMembers
+{
+    static constexpr FeatureMemberName s_Members[] = {
+#define VKEFH_CORE_FEATURE_MEMBER(memberName) \
+    { "VkPhysicalDeviceFeatures", #memberName, DeviceFeatureBit{DeviceFeatureStructId::VkPhysicalDeviceFeatures, (uint32_t)offsetof(VkPhysicalDeviceFeatures, memberName)} },
+VKEFH_CORE_FEATURE_MEMBER(robustBufferAccess)
+VKEFH_CORE_FEATURE_MEMBER(fullDrawIndexUint32)
+VKEFH_CORE_FEATURE_MEMBER(imageCubeArray)
+VKEFH_CORE_FEATURE_MEMBER(independentBlend)
+VKEFH_CORE_FEATURE_MEMBER(geometryShader)
+VKEFH_CORE_FEATURE_MEMBER(tessellationShader)
+VKEFH_CORE_FEATURE_MEMBER(sampleRateShading)
+VKEFH_CORE_FEATURE_MEMBER(dualSrcBlend)
+VKEFH_CORE_FEATURE_MEMBER(logicOp)
+VKEFH_CORE_FEATURE_MEMBER(multiDrawIndirect)
+VKEFH_CORE_FEATURE_MEMBER(drawIndirectFirstInstance)
+VKEFH_CORE_FEATURE_MEMBER(depthClamp)
+VKEFH_CORE_FEATURE_MEMBER(depthBiasClamp)
+VKEFH_CORE_FEATURE_MEMBER(fillModeNonSolid)
+VKEFH_CORE_FEATURE_MEMBER(depthBounds)
+VKEFH_CORE_FEATURE_MEMBER(wideLines)
+VKEFH_CORE_FEATURE_MEMBER(largePoints)
+VKEFH_CORE_FEATURE_MEMBER(alphaToOne)
+VKEFH_CORE_FEATURE_MEMBER(multiViewport)
+VKEFH_CORE_FEATURE_MEMBER(samplerAnisotropy)
+VKEFH_CORE_FEATURE_MEMBER(textureCompressionETC2)
+VKEFH_CORE_FEATURE_MEMBER(textureCompressionASTC_LDR)
+VKEFH_CORE_FEATURE_MEMBER(textureCompressionBC)
+VKEFH_CORE_FEATURE_MEMBER(occlusionQueryPrecise)
+VKEFH_CORE_FEATURE_MEMBER(pipelineStatisticsQuery)
+VKEFH_CORE_FEATURE_MEMBER(vertexPipelineStoresAndAtomics)
+VKEFH_CORE_FEATURE_MEMBER(fragmentStoresAndAtomics)
+VKEFH_CORE_FEATURE_MEMBER(shaderTessellationAndGeometryPointSize)
+VKEFH_CORE_FEATURE_MEMBER(shaderImageGatherExtended)
+VKEFH_CORE_FEATURE_MEMBER(shaderStorageImageExtendedFormats)
+VKEFH_CORE_FEATURE_MEMBER(shaderStorageImageMultisample)
+VKEFH_CORE_FEATURE_MEMBER(shaderStorageImageReadWithoutFormat)
+VKEFH_CORE_FEATURE_MEMBER(shaderStorageImageWriteWithoutFormat)
+VKEFH_CORE_FEATURE_MEMBER(shaderUniformBufferArrayDynamicIndexing)
+VKEFH_CORE_FEATURE_MEMBER(shaderSampledImageArrayDynamicIndexing)
+VKEFH_CORE_FEATURE_MEMBER(shaderStorageBufferArrayDynamicIndexing)
+VKEFH_CORE_FEATURE_MEMBER(shaderStorageImageArrayDynamicIndexing)
+VKEFH_CORE_FEATURE_MEMBER(shaderClipDistance)
+VKEFH_CORE_FEATURE_MEMBER(shaderCullDistance)
+VKEFH_CORE_FEATURE_MEMBER(shaderFloat64)
+VKEFH_CORE_FEATURE_MEMBER(shaderInt64)
+VKEFH_CORE_FEATURE_MEMBER(shaderInt16)
+VKEFH_CORE_FEATURE_MEMBER(shaderResourceResidency)
+VKEFH_CORE_FEATURE_MEMBER(shaderResourceMinLod)
+VKEFH_CORE_FEATURE_MEMBER(sparseBinding)
+VKEFH_CORE_FEATURE_MEMBER(sparseResidencyBuffer)
+VKEFH_CORE_FEATURE_MEMBER(sparseResidencyImage2D)
+VKEFH_CORE_FEATURE_MEMBER(sparseResidencyImage3D)
+VKEFH_CORE_FEATURE_MEMBER(sparseResidency2Samples)
+VKEFH_CORE_FEATURE_MEMBER(sparseResidency4Samples)
+VKEFH_CORE_FEATURE_MEMBER(sparseResidency8Samples)
+VKEFH_CORE_FEATURE_MEMBER(sparseResidency16Samples)
+VKEFH_CORE_FEATURE_MEMBER(sparseResidencyAliased)
+VKEFH_CORE_FEATURE_MEMBER(variableMultisampleRate)
+VKEFH_CORE_FEATURE_MEMBER(inheritedQueries)
+#undef VKEFH_CORE_FEATURE_MEMBER
+#define VKEFH_DEVICE_FEATURE_MEMBER(structName, memberName)   { #structName, #memberName, DeviceFeatureBit{DeviceFeatureStructId::structName, (uint32_t)offsetof(structName, memberName)} },
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+        { nullptr, nullptr, {} } };
+};
+template<typename T> constexpr FeatureMemberName DefinitionFeatureMembers<T>::s_Members[];
+
+// Tables of names specified in VkExtensionsFeatures.inl. Template only to allow defining them in the header.
+// Each one is terminated with null so it is never empty.
+template<typename T = void>
+struct DefinitionNames
+{
+    static constexpr const char* const s_InstanceExtensions[] = {
+#define VKEFH_INSTANCE_EXTENSION(extensionName)   (extensionName),
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+        nullptr };
+    static constexpr const char* const s_InstanceLayers[] = {
+#define VKEFH_INSTANCE_LAYER(layerName)   (layerName),
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+        nullptr };
+    static constexpr const char* const s_DeviceExtensions[] = {
+#define VKEFH_DEVICE_EXTENSION(extensionName)   (extensionName),
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+        nullptr };
+};
+template<typename T> constexpr const char* const DefinitionNames<T>::s_InstanceExtensions[];
+template<typename T> constexpr const char* const DefinitionNames<T>::s_InstanceLayers[];
+template<typename T> constexpr const char* const DefinitionNames<T>::s_DeviceExtensions[];
+
+/*
+Return ID of an item specified in VkExtensionsFeatures.inl, or value INVALID_ID if not found.
+They can be evaluated at compile time, e.g.:
+
+    constexpr VKEFH::DeviceExtensionId memoryPriorityExt =
+        VKEFH::GetDeviceExtensionId(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME);
+*/
+constexpr InstanceExtensionId GetInstanceExtensionId(const char* extensionName)
+{
+    return (InstanceExtensionId)FindName(DefinitionNames<>::s_InstanceExtensions, extensionName, 0, INSTANCE_EXTENSION_COUNT);
+}
+constexpr InstanceLayerId GetInstanceLayerId(const char* layerName)
+{
+    return (InstanceLayerId)FindName(DefinitionNames<>::s_InstanceLayers, layerName, 0, INSTANCE_LAYER_COUNT);
+}
+constexpr DeviceExtensionId GetDeviceExtensionId(const char* extensionName)
+{
+    return (DeviceExtensionId)FindName(DefinitionNames<>::s_DeviceExtensions, extensionName, 0, DEVICE_EXTENSION_COUNT);
+}
+
+/*
+Extensions and features specified using VKEFH_DEVICE_EXTENSION_REQUIRED and VKEFH_DEVICE_FEATURE_REQUIRED.
+Template only to allow defining it in the header. Terminated with INVALID_ID.
+*/
+template<typename T = void>
+struct DefinitionRequirements
+{
+    static constexpr DeviceExtensionId s_DeviceExtensions[] = {
+#define VKEFH_DEVICE_EXTENSION_REQUIRED(extensionName)   GetDeviceExtensionId(extensionName),
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+        (DeviceExtensionId)INVALID_ID };
+    static constexpr DeviceFeatureBit s_DeviceFeatures[] = {
+#define VKEFH_DEVICE_FEATURE_REQUIRED(structName, memberName)   DeviceFeatureBit{DeviceFeatureStructId::structName, (uint32_t)offsetof(structName, memberName)},
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+        DeviceFeatureBit{(DeviceFeatureStructId)INVALID_ID, 0} };
+
+    static constexpr bool HasExtension(DeviceExtensionId extensionId, uint32_t index)
+    {
+        return s_DeviceExtensions[index] != (DeviceExtensionId)INVALID_ID &&
+            (s_DeviceExtensions[index] == extensionId || HasExtension(extensionId, index + 1));
+    }
+    static constexpr bool HasFeature(DeviceFeatureBit bit, uint32_t index)
+    {
+        return s_DeviceFeatures[index].m_Struct != (DeviceFeatureStructId)INVALID_ID &&
+            ((s_DeviceFeatures[index].m_Struct == bit.m_Struct && s_DeviceFeatures[index].m_Offset == bit.m_Offset) ||
+                HasFeature(bit, index + 1));
+    }
+};
+template<typename T> constexpr DeviceExtensionId DefinitionRequirements<T>::s_DeviceExtensions[];
+template<typename T> constexpr DeviceFeatureBit DefinitionRequirements<T>::s_DeviceFeatures[];
+
+/*
+Return true if given extension or feature is specified as required in VkExtensionsFeatures.inl.
+They can be used in a static_assert or another constant expression, e.g.:
+
+    static_assert(VKEFH::IsDeviceFeatureRequired(VKEFH_FEATURE_BIT(VkPhysicalDeviceVulkan12Features, bufferDeviceAddress)), "");
+*/
+constexpr bool IsDeviceExtensionRequired(DeviceExtensionId extensionId)
+{
+    return DefinitionRequirements<>::HasExtension(extensionId, 0);
+}
+constexpr bool IsDeviceFeatureRequired(DeviceFeatureBit bit)
+{
+    return DefinitionRequirements<>::HasFeature(bit, 0);
+}
+
+/*
+Rule of a driver quirk table. It matches devices by vendorID and deviceID, where 0 means any,
+and a range of driver versions, inclusive. It applies to a device extension or, if m_Extension
+is INVALID_ID, to a device feature.
+*/
+struct DriverQuirk
+{
+    uint32_t m_VendorID;
+    uint32_t m_DeviceID;
+    uint32_t m_MinDriverVersion;
+    uint32_t m_MaxDriverVersion;
+    DeviceExtensionId m_Extension;
+    DeviceFeatureBit m_Feature;
+    DriverQuirkAction m_Action;
+};
+
+// Rules specified using VKEFH_DEVICE_EXTENSION_QUIRK and VKEFH_DEVICE_FEATURE_QUIRK, in the order of the definition file.
+// Template only to allow defining it in the header. The last element is only a placeholder, so the array is never empty.
+template<typename T = void>
+struct DefinitionQuirks
+{
+    static constexpr DriverQuirk s_Quirks[] = {
+#define VKEFH_DEVICE_EXTENSION_QUIRK(vendorID, deviceID, minDriverVersion, maxDriverVersion, extensionName, action)   DriverQuirk{(vendorID), (deviceID), (minDriverVersion), (maxDriverVersion), GetDeviceExtensionId(extensionName), DeviceFeatureBit{(DeviceFeatureStructId)INVALID_ID, 0}, DriverQuirkAction::action},
+#define VKEFH_DEVICE_FEATURE_QUIRK(vendorID, deviceID, minDriverVersion, maxDriverVersion, structName, memberName, action)   DriverQuirk{(vendorID), (deviceID), (minDriverVersion), (maxDriverVersion), (DeviceExtensionId)INVALID_ID, DeviceFeatureBit{DeviceFeatureStructId::structName, (uint32_t)offsetof(structName, memberName)}, DriverQuirkAction::action},
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+        DriverQuirk{0, 0, 0, 0, (DeviceExtensionId)INVALID_ID, DeviceFeatureBit{(DeviceFeatureStructId)INVALID_ID, 0}, DriverQuirkAction::Disable} };
+    static constexpr size_t s_Count = sizeof(s_Quirks) / sizeof(DriverQuirk) - 1;
+
+    // Returns true if rules from index to the end are sorted by vendorID, then deviceID.
+    static constexpr bool IsSorted(size_t index)
+    {
+        return index + 1 >= s_Count ||
+            ((s_Quirks[index].m_VendorID < s_Quirks[index + 1].m_VendorID ||
+                (s_Quirks[index].m_VendorID == s_Quirks[index + 1].m_VendorID &&
+                    s_Quirks[index].m_DeviceID <= s_Quirks[index + 1].m_DeviceID)) &&
+                IsSorted(index + 1));
+    }
+
+#define VKEFH_DEVICE_EXTENSION_QUIRK(vendorID, deviceID, minDriverVersion, maxDriverVersion, extensionName, action)   static_assert(GetDeviceExtensionId(extensionName) != (DeviceExtensionId)INVALID_ID, "Extensions used in VKEFH_DEVICE_EXTENSION_QUIRK must be specified in VkExtensionsFeatures.inl.");
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+};
+template<typename T> constexpr DriverQuirk DefinitionQuirks<T>::s_Quirks[];
+
+// DriverQuirkTable copies built-in rules as they are, so they need to be already sorted.
+static_assert(DefinitionQuirks<>::IsSorted(0),
+    "VKEFH_DEVICE_EXTENSION_QUIRK and VKEFH_DEVICE_FEATURE_QUIRK must be sorted by vendorID, then deviceID.");
+
+class InstanceInitHelp : public InitHelpBase<InstanceExtensionId, InstanceFeatureStructId,
+    INSTANCE_EXTENSION_COUNT, INSTANCE_FEATURE_STRUCT_COUNT, INSTANCE_EXTENSION_DEPENDENCY_COUNT>
 {
 	InstanceInitHelp(const InstanceInitHelp&) = delete;
 	InstanceInitHelp(InstanceInitHelp&&) = delete;
 	InstanceInitHelp& operator=(const InstanceInitHelp&) = delete;
 	InstanceInitHelp& operator=(InstanceInitHelp&&) = delete;
 
-#define VKEFH_INSTANCE_EXTENSION(extensionName)
-#define VKEFH_INSTANCE_LAYER(layerName)
 #define VKEFH_INSTANCE_FEATURE_STRUCT(structName, sType) \
     private: structName m_##structName = { (sType) }; \
     public: structName& Get##structName() { return m_##structName; } \
     public: const structName& Get##structName() const { return m_##structName; }
-#define VKEFH_DEVICE_EXTENSION(extensionName)
-#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)
-
-#include "VkExtensionsFeatures.inl"
-
-#undef VKEFH_INSTANCE_EXTENSION
-#undef VKEFH_INSTANCE_LAYER
-#undef VKEFH_INSTANCE_FEATURE_STRUCT
-#undef VKEFH_DEVICE_EXTENSION
-#undef VKEFH_DEVICE_FEATURE_STRUCT
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
 
 public:
     InstanceInitHelp()
     {
-#define VKEFH_INSTANCE_EXTENSION(extensionName)   m_Extensions.m_Items.push_back({(extensionName), false, false});
-#define VKEFH_INSTANCE_LAYER(layerName)   m_Layers.m_Items.push_back({(layerName), false, false});
-#define VKEFH_INSTANCE_FEATURE_STRUCT(structName, sType)   m_FeatureStructs.push_back({(#structName), (sType), (VkBaseInStructure*)(&m_##structName), true});
-#define VKEFH_DEVICE_EXTENSION(extensionName)
-#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)
+        m_Extensions.Init(DefinitionNames<>::s_InstanceExtensions);
+        m_Layers.Init(DefinitionNames<>::s_InstanceLayers);
+
+#define VKEFH_INSTANCE_FEATURE_STRUCT(structName, sType)   m_FeatureStructs[(size_t)InstanceFeatureStructId::structName] = {(#structName), (sType), (VkBaseInStructure*)(&m_##structName), (VkBaseInStructure*)(&m_##structName), (uint32_t)sizeof(structName), 0, true, false, false, false, true, INVALID_ID, 0};
+#define VKEFH_INSTANCE_EXTENSION_REQUIRES(extensionName, requiredExtensionName)   static_assert(GetInstanceExtensionId(extensionName) != (InstanceExtensionId)INVALID_ID && GetInstanceExtensionId(requiredExtensionName) != (InstanceExtensionId)INVALID_ID, "Extensions used in VKEFH_INSTANCE_EXTENSION_REQUIRES must be specified in VkExtensionsFeatures.inl."); AddExtensionDependency((extensionName), (requiredExtensionName));
+#define VKEFH_INSTANCE_EXTENSION_PROMOTED(extensionName, apiVersion)   static_assert(GetInstanceExtensionId(extensionName) != (InstanceExtensionId)INVALID_ID, "Extensions used in VKEFH_INSTANCE_EXTENSION_PROMOTED must be specified in VkExtensionsFeatures.inl."); SetExtensionPromotedVersion((extensionName), (apiVersion));
+#define VKEFH_INSTANCE_FEATURE_STRUCT_REQUIRES(structName, extensionName, apiVersion)   SetFeatureStructRequirement(InstanceFeatureStructId::structName, (extensionName), (apiVersion));
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
 
-#include "VkExtensionsFeatures.inl"
+        SortExtensionDependencies();
+        ResetFeatureChain();
+    }
+
+	void Reset()
+	{
+		InitHelpBase::Reset();
+		m_LayersEnumerated = false;
+		m_Layers.Reset();
+		m_FeaturesChain = nullptr;
+	}
+
+    VkResult EnumerateExtensions()
+    {
+        VKEFH_INSTRUMENT_PHASE(EnumerateExtensions);
+        VKEFH_ASSERT(m_VulkanFunctions.vkEnumerateInstanceExtensionProperties && "Vulkan function vkEnumerateInstanceExtensionProperties is not available.");
+        uint32_t extPropCount = 0;
+        VkResult res = m_VulkanFunctions.vkEnumerateInstanceExtensionProperties(nullptr, &extPropCount, nullptr);
+        if(res != VK_SUCCESS)
+            return res;
+        if(extPropCount)
+        {
+            std::vector<VkExtensionProperties> extProps(extPropCount);
+            res = m_VulkanFunctions.vkEnumerateInstanceExtensionProperties(nullptr, &extPropCount, extProps.data());
+            if(res != VK_SUCCESS)
+                return res;
+            LoadExtensions(extProps.data(), extPropCount);
+        }
+        else
+            LoadExtensions(nullptr, 0);
+        return VK_SUCCESS;
+    }
+
+    /*
+    Like EnumerateExtensions(), but uses memory provided by the caller instead of allocating it,
+    and needs only one call to Vulkan. Returns VK_INCOMPLETE if scratchCapacity is too small
+    to hold all the extensions - then you can call it again with a larger buffer.
+    */
+    VkResult EnumerateExtensions(VkExtensionProperties* scratch, uint32_t scratchCapacity)
+    {
+        VKEFH_INSTRUMENT_PHASE(EnumerateExtensions);
+        VKEFH_ASSERT(m_VulkanFunctions.vkEnumerateInstanceExtensionProperties && "Vulkan function vkEnumerateInstanceExtensionProperties is not available.");
+        VKEFH_ASSERT(scratch);
+        uint32_t extPropCount = scratchCapacity;
+        VkResult res = m_VulkanFunctions.vkEnumerateInstanceExtensionProperties(nullptr, &extPropCount, scratch);
+        if(res != VK_SUCCESS)
+            return res;
+        LoadExtensions(scratch, extPropCount);
+        return VK_SUCCESS;
+    }
+
+    VkResult EnumerateLayers()
+    {
+        VKEFH_INSTRUMENT_PHASE(EnumerateLayers);
+        VKEFH_ASSERT(m_VulkanFunctions.vkEnumerateInstanceLayerProperties && "Vulkan function vkEnumerateInstanceLayerProperties is not available.");
+        VKEFH_ASSERT(!m_LayersEnumerated && "You should call EnumerateLayers only once.");
+        uint32_t layerPropCount = 0;
+        VkResult res = m_VulkanFunctions.vkEnumerateInstanceLayerProperties(&layerPropCount, nullptr);
+        if(res != VK_SUCCESS)
+            return res;
+        if(layerPropCount)
+        {
+            std::vector<VkLayerProperties> layerProps(layerPropCount);
+            res = m_VulkanFunctions.vkEnumerateInstanceLayerProperties(&layerPropCount, layerProps.data());
+            if(res != VK_SUCCESS)
+                return res;
+            LoadLayers(layerProps.data(), layerPropCount);
+        }
+        else
+            LoadLayers(nullptr, 0);
+        return VK_SUCCESS;
+    }
+
+    /*
+    Like EnumerateLayers(), but uses memory provided by the caller instead of allocating it,
+    and needs only one call to Vulkan. Returns VK_INCOMPLETE if scratchCapacity is too small
+    to hold all the layers - then you can call it again with a larger buffer.
+    */
+    VkResult EnumerateLayers(VkLayerProperties* scratch, uint32_t scratchCapacity)
+    {
+        VKEFH_INSTRUMENT_PHASE(EnumerateLayers);
+        VKEFH_ASSERT(m_VulkanFunctions.vkEnumerateInstanceLayerProperties && "Vulkan function vkEnumerateInstanceLayerProperties is not available.");
+        VKEFH_ASSERT(!m_LayersEnumerated && "You should call EnumerateLayers only once.");
+        VKEFH_ASSERT(scratch);
+        uint32_t layerPropCount = scratchCapacity;
+        VkResult res = m_VulkanFunctions.vkEnumerateInstanceLayerProperties(&layerPropCount, scratch);
+        if(res != VK_SUCCESS)
+            return res;
+        LoadLayers(scratch, layerPropCount);
+        return VK_SUCCESS;
+    }
+
+#if VKEFH_USE_THREADS
+    /*
+    Starts EnumerateLayers() and EnumerateExtensions() on background threads, running concurrently
+    with each other and with the calling thread. They touch disjoint data, so it is safe.
+    The returned future becomes ready when both have finished. Its value is the result of
+    EnumerateExtensions() if it failed, otherwise the result of EnumerateLayers().
+    Don't access this object until the future is ready.
+    Available only when VKEFH_USE_THREADS is 1, which is the default.
+    */
+    std::future<VkResult> EnumerateAsync()
+    {
+        return std::async(std::launch::async, [this]() -> VkResult
+        {
+            std::future<VkResult> layersResult = std::async(std::launch::async, [this]() -> VkResult
+            {
+                return EnumerateLayers();
+            });
+            const VkResult extensionsResult = EnumerateExtensions();
+            const VkResult layerResult = layersResult.get();
+            return extensionsResult != VK_SUCCESS ? extensionsResult : layerResult;
+        });
+    }
+#endif
+
+    /*
+    Alternative to EnumerateLayers that takes a list of layers obtained in some other way,
+    e.g. recorded earlier or generated synthetically for testing and benchmarking.
+    */
+    void LoadLayers(const VkLayerProperties* layerProps, size_t layerPropCount)
+    {
+        VKEFH_ASSERT(!m_LayersEnumerated && "You should call EnumerateLayers only once.");
+        for(size_t layerPropIndex = 0; layerPropIndex < layerPropCount; ++layerPropIndex)
+        {
+            const size_t layerIndex = m_Layers.Find(layerProps[layerPropIndex].layerName);
+            if(layerIndex != SIZE_MAX)
+            {
+                m_Layers.m_Items[layerIndex].m_Supported = true;
+                m_Layers.m_Items[layerIndex].m_Enabled = true;
+            }
+        }
+        m_LayersEnumerated = true;
+#if VKEFH_INSTRUMENTATION
+        m_Instrumentation.m_Layers.m_Reported = (uint32_t)layerPropCount;
+        m_Instrumentation.m_Layers.m_Declared = INSTANCE_LAYER_COUNT;
+        m_Instrumentation.m_Layers.m_Matched = 0;
+        for(uint32_t i = 0; i < INSTANCE_LAYER_COUNT; ++i)
+        {
+            if(m_Layers.m_Items[i].m_Supported)
+                ++m_Instrumentation.m_Layers.m_Matched;
+        }
+#endif
+    }
+
+    bool IsLayerSupported(const char* layerName) const
+    {
+        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
+        return m_Layers.IsSupported(layerName);
+    }
+    bool IsLayerEnabled(const char* layerName) const
+    {
+        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
+        return m_Layers.IsEnabled(layerName);
+    }
+    bool EnableLayer(const char* layerName, bool enabled)
+    {
+        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
+        return m_Layers.Enable(layerName, enabled);
+    }
+    bool IsLayerSupported(InstanceLayerId layer) const
+    {
+        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
+        return m_Layers.IsSupported((uint32_t)layer);
+    }
+    bool IsLayerEnabled(InstanceLayerId layer) const
+    {
+        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
+        return m_Layers.IsEnabled((uint32_t)layer);
+    }
+    bool EnableLayer(InstanceLayerId layer, bool enabled)
+    {
+        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
+        return m_Layers.Enable((uint32_t)layer, enabled);
+    }
+    void EnableAllLayers(bool enabled)
+    {
+        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
+        m_Layers.EnableAll(enabled);
+    }
+
+    // Returns VkResult like DeviceInitHelp::PrepareCreation. Currently nothing can fail, so it is always VK_SUCCESS.
+    VkResult PrepareCreation()
+    {
+        VKEFH_INSTRUMENT_PHASE(PrepareCreation);
+        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
+        
+        PrepareEnabledExtensionNames();
+        
+        m_Layers.PrepareEnabled();
+        
+        UpdateAvailableFeatureStructs(true, m_TargetApiVersion);
+        UpdateFeatureChain(m_FeaturesChain);
+
+        m_CreationPrepared = true;
+#if VKEFH_INSTRUMENTATION
+        m_Instrumentation.m_Extensions.m_Enabled = m_Extensions.m_EnabledItemCount;
+        m_Instrumentation.m_Layers.m_Enabled = m_Layers.m_EnabledItemCount;
+        m_Instrumentation.m_CreationChainLength = CountLinkedFeatureStructs();
+#endif
+        return VK_SUCCESS;
+    }
+
+    uint32_t GetEnabledLayerCount() const
+    {
+        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
+        return m_Layers.m_EnabledItemCount;
+    }
+    const char* const* GetEnabledLayerNames() const
+    {
+        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
+        return m_Layers.m_EnabledItemCount > 0 ? m_Layers.m_EnabledItemNames.data() : nullptr;
+    }
+    const void* GetFeaturesChain() const
+    {
+        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
+        return m_FeaturesChain;
+    }
+
+private:
+    bool m_LayersEnumerated = false;
+    EnabledItemVector<INSTANCE_LAYER_COUNT> m_Layers;
+    void* m_FeaturesChain = nullptr;
+};
+
+// Copies of VkPhysicalDeviceFeatures and all device feature structures specified in VkExtensionsFeatures.inl.
+struct DeviceFeatureStructs
+{
+    VkPhysicalDeviceFeatures m_VkPhysicalDeviceFeatures;
+#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)   structName m_##structName;
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+};
+
+// Offsets of members of DeviceFeatureStructs, indexed by DeviceFeatureStructId. Template only to allow defining it in the header.
+template<typename T = void>
+struct DeviceFeatureStructOffsets
+{
+    static constexpr uint32_t s_Offsets[] = {
+#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)   (uint32_t)offsetof(DeviceFeatureStructs, m_##structName),
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+        (uint32_t)offsetof(DeviceFeatureStructs, m_VkPhysicalDeviceFeatures) };
+};
+template<typename T> constexpr uint32_t DeviceFeatureStructOffsets<T>::s_Offsets[];
+
+/*
+Immutable snapshot of extensions and features enabled for creation of a device, returned by
+DeviceInitHelp::GetCapabilities. Queries only read packed bits or copies of feature structures,
+so the object can be used by multiple threads at the same time without synchronization.
+*/
+class DeviceCapabilities
+{
+public:
+    bool IsExtensionEnabled(DeviceExtensionId extension) const
+    {
+        const uint32_t index = (uint32_t)extension;
+        VKEFH_ASSERT(index < DEVICE_EXTENSION_COUNT);
+        return (m_ExtensionBits[index / 32] >> (index % 32) & 1u) != 0;
+    }
+    // Extensions specified using VKEFH_DEVICE_EXTENSION_REQUIRED fold to a constant true.
+    template<DeviceExtensionId extension>
+    bool IsExtensionEnabled() const
+    {
+        static_assert((uint32_t)extension < DEVICE_EXTENSION_COUNT, "Unknown extension.");
+        return IsDeviceExtensionRequired(extension) ||
+            (m_ExtensionBits[(uint32_t)extension / 32] >> ((uint32_t)extension % 32) & 1u) != 0;
+    }
+    bool IsFeatureStructEnabled(DeviceFeatureStructId structId) const
+    {
+        const uint32_t index = (uint32_t)structId;
+        VKEFH_ASSERT(index < DEVICE_FEATURE_STRUCT_COUNT);
+        return (m_FeatureStructBits[index / 32] >> (index % 32) & 1u) != 0;
+    }
+    // Members of feature structures that were not enabled are VK_FALSE.
+    VkBool32 GetFeatureBit(DeviceFeatureBit bit) const
+    {
+        VKEFH_ASSERT((uint32_t)bit.m_Struct <= DEVICE_FEATURE_STRUCT_COUNT);
+        return *(const VkBool32*)((const char*)&m_Structs +
+            DeviceFeatureStructOffsets<>::s_Offsets[(uint32_t)bit.m_Struct] + bit.m_Offset);
+    }
+    /*
+    Same, with the bit passed as template parameters, e.g.:
+
+        caps.GetFeatureBit<VKEFH::DeviceFeatureStructId::VkPhysicalDeviceFeatures,
+            offsetof(VkPhysicalDeviceFeatures, samplerAnisotropy)>()
+
+    Features specified using VKEFH_DEVICE_FEATURE_REQUIRED fold to a constant VK_TRUE.
+    */
+    template<DeviceFeatureStructId structId, uint32_t offset>
+    VkBool32 GetFeatureBit() const
+    {
+        static_assert((uint32_t)structId <= DEVICE_FEATURE_STRUCT_COUNT, "Unknown feature structure.");
+        return IsDeviceFeatureRequired(DeviceFeatureBit{structId, offset}) ? VK_TRUE :
+            *(const VkBool32*)((const char*)&m_Structs + DeviceFeatureStructOffsets<>::s_Offsets[(uint32_t)structId] + offset);
+    }
+    const VkPhysicalDeviceFeatures& GetFeatures() const { return m_Structs.m_VkPhysicalDeviceFeatures; }
+
+#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)   const structName& Get##structName() const { return m_Structs.m_##structName; }
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+
+private:
+    friend class DeviceInitHelp;
+
+    std::array<uint32_t, (DEVICE_EXTENSION_COUNT + 31) / 32> m_ExtensionBits = {};
+    std::array<uint32_t, (DEVICE_FEATURE_STRUCT_COUNT + 31) / 32> m_FeatureStructBits = {};
+    DeviceFeatureStructs m_Structs = {};
+};
+
+/*
+Rules that disable extensions and features known to be slow or broken on specific drivers, used by
+DeviceInitHelp::ApplyDriverQuirks. Starts with rules specified in VkExtensionsFeatures.inl and can be
+extended with rules loaded from a JSON file at run time. Rules are kept sorted by vendorID and deviceID,
+so finding the ones for a device is a binary search.
+*/
+class DriverQuirkTable
+{
+public:
+    DriverQuirkTable() :
+        m_Quirks(DefinitionQuirks<>::s_Quirks, DefinitionQuirks<>::s_Quirks + DefinitionQuirks<>::s_Count)
+    {
+    }
+
+    void AddQuirk(const DriverQuirk& quirk)
+    {
+        VKEFH_ASSERT(IsValid(quirk));
+        m_Quirks.insert(std::upper_bound(m_Quirks.begin(), m_Quirks.end(), quirk, KeyLess), quirk);
+    }
+
+    /*
+    Adds rules from JSON like:
+
+        {"quirks": {
+            "Slow descriptor buffer": {"vendorID": 4318, "maxDriverVersion": 2254962688,
+                "extension": "VK_EXT_descriptor_buffer", "action": "disable"},
+            "Slow BDA capture": {"vendorID": 4098, "deviceID": 29631,
+                "struct": "VkPhysicalDeviceVulkan12Features", "member": "bufferDeviceAddressCaptureReplay",
+                "action": "notPreferred"}
+        }}
+
+    Names of the rules are ignored. "vendorID" and "deviceID" default to 0 - any. "minDriverVersion" and
+    "maxDriverVersion" default to the full range. "action" is "disable" or "notPreferred", default "disable".
+    Rules for extensions not specified in VkExtensionsFeatures.inl or members of feature structures
+    not specified using VKEFH_DEVICE_FEATURE_MEMBER are skipped. Returns false if the JSON is malformed -
+    then no rules are added.
+    */
+    bool LoadFromJson(const char* json, size_t length)
+    {
+        JsonReader reader(json, length);
+        std::vector<DriverQuirk> quirks;
+        const char* key;
+        size_t keyLength;
+        if(!reader.BeginObject())
+            return false;
+        while(reader.NextKey(key, keyLength))
+        {
+            if(!JsonReader::KeyEquals(key, keyLength, "quirks"))
+            {
+                if(!reader.SkipValue())
+                    return false;
+                continue;
+            }
+            if(!reader.BeginObject())
+                return false;
+            while(reader.NextKey(key, keyLength))
+            {
+                DriverQuirk quirk;
+                bool known;
+                if(!ReadJsonQuirk(reader, quirk, known))
+                    return false;
+                if(known)
+                    quirks.push_back(quirk);
+            }
+            if(reader.HasFailed())
+                return false;
+        }
+        if(reader.HasFailed())
+            return false;
+        for(size_t i = 0; i < quirks.size(); ++i)
+            AddQuirk(quirks[i]);
+        return true;
+    }
+
+#if VKEFH_USE_MAPPED_FILES
+    // Maps given file into memory and calls LoadFromJson. Returns false also if the file cannot be opened.
+    bool LoadFromJsonFile(const char* filePath)
+    {
+        MappedFile file;
+        if(!file.Open(filePath))
+            return false;
+        return LoadFromJson((const char*)file.GetData(), file.GetSize());
+    }
+#endif // #if VKEFH_USE_MAPPED_FILES
+
+    size_t GetQuirkCount() const { return m_Quirks.size(); }
+    const DriverQuirk& GetQuirk(size_t index) const { return m_Quirks[index]; }
+
+    /*
+    Returns range [outBegin, outEnd) of rules with exactly given vendorID and deviceID, which may be 0.
+    Rules that match a device can have its own IDs, only its vendorID or only its deviceID with the other ID 0,
+    or both IDs 0.
+    */
+    void FindQuirks(uint32_t vendorID, uint32_t deviceID, const DriverQuirk*& outBegin, const DriverQuirk*& outEnd) const
+    {
+        DriverQuirk key = {};
+        key.m_VendorID = vendorID;
+        key.m_DeviceID = deviceID;
+        const auto range = std::equal_range(m_Quirks.begin(), m_Quirks.end(), key, KeyLess);
+        outBegin = m_Quirks.data() + (range.first - m_Quirks.begin());
+        outEnd = m_Quirks.data() + (range.second - m_Quirks.begin());
+    }
+
+private:
+    std::vector<DriverQuirk> m_Quirks;
+
+    static bool KeyLess(const DriverQuirk& lhs, const DriverQuirk& rhs)
+    {
+        return lhs.m_VendorID != rhs.m_VendorID ? lhs.m_VendorID < rhs.m_VendorID : lhs.m_DeviceID < rhs.m_DeviceID;
+    }
+    // Rules for extensions not specified in VkExtensionsFeatures.inl have m_Extension equal to INVALID_ID.
+    static bool IsValid(const DriverQuirk& quirk)
+    {
+        return quirk.m_Extension != (DeviceExtensionId)INVALID_ID ?
+            (uint32_t)quirk.m_Extension < DEVICE_EXTENSION_COUNT :
+            (uint32_t)quirk.m_Feature.m_Struct <= DEVICE_FEATURE_STRUCT_COUNT;
+    }
+
+    // Reads one rule. outKnown is false if it refers to an extension or feature not known to the definition file.
+    static bool ReadJsonQuirk(JsonReader& reader, DriverQuirk& outQuirk, bool& outKnown)
+    {
+        outQuirk = DriverQuirk{0, 0, 0, UINT32_MAX, (DeviceExtensionId)INVALID_ID,
+            DeviceFeatureBit{(DeviceFeatureStructId)INVALID_ID, 0}, DriverQuirkAction::Disable};
+        const char* extension = nullptr;
+        const char* structName = nullptr;
+        const char* memberName = nullptr;
+        size_t extensionLength = 0, structNameLength = 0, memberNameLength = 0;
+        const char* key;
+        size_t keyLength;
+        if(!reader.BeginObject())
+            return false;
+        while(reader.NextKey(key, keyLength))
+        {
+            bool ok;
+            if(JsonReader::KeyEquals(key, keyLength, "vendorID"))
+                ok = reader.ReadUint32(outQuirk.m_VendorID);
+            else if(JsonReader::KeyEquals(key, keyLength, "deviceID"))
+                ok = reader.ReadUint32(outQuirk.m_DeviceID);
+            else if(JsonReader::KeyEquals(key, keyLength, "minDriverVersion"))
+                ok = reader.ReadUint32(outQuirk.m_MinDriverVersion);
+            else if(JsonReader::KeyEquals(key, keyLength, "maxDriverVersion"))
+                ok = reader.ReadUint32(outQuirk.m_MaxDriverVersion);
+            else if(JsonReader::KeyEquals(key, keyLength, "extension"))
+                ok = reader.ReadString(extension, extensionLength);
+            else if(JsonReader::KeyEquals(key, keyLength, "struct"))
+                ok = reader.ReadString(structName, structNameLength);
+            else if(JsonReader::KeyEquals(key, keyLength, "member"))
+                ok = reader.ReadString(memberName, memberNameLength);
+            else if(JsonReader::KeyEquals(key, keyLength, "action"))
+            {
+                const char* action;
+                size_t actionLength;
+                ok = reader.ReadString(action, actionLength);
+                if(ok && JsonReader::KeyEquals(action, actionLength, "disable"))
+                    outQuirk.m_Action = DriverQuirkAction::Disable;
+                else if(ok && JsonReader::KeyEquals(action, actionLength, "notPreferred"))
+                    outQuirk.m_Action = DriverQuirkAction::NotPreferred;
+                else
+                    ok = false;
+            }
+            else
+                ok = reader.SkipValue();
+            if(!ok)
+                return false;
+        }
+        if(reader.HasFailed() || (extension != nullptr) == (structName != nullptr) || (structName != nullptr) != (memberName != nullptr))
+            return false;
+
+        outKnown = false;
+        if(extension != nullptr)
+        {
+            for(uint32_t i = 0; i < DEVICE_EXTENSION_COUNT; ++i)
+            {
+                if(JsonReader::KeyEquals(extension, extensionLength, DefinitionNames<>::s_DeviceExtensions[i]))
+                {
+                    outQuirk.m_Extension = (DeviceExtensionId)i;
+                    outKnown = true;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            for(const FeatureMemberName* m = DefinitionFeatureMembers<>::s_Members; m->m_StructName != nullptr; ++m)
+            {
+                if(JsonReader::KeyEquals(structName, structNameLength, m->m_StructName) &&
+                    JsonReader::KeyEquals(memberName, memberNameLength, m->m_MemberName))
+                {
+                    outQuirk.m_Feature = m->m_Bit;
+                    outKnown = true;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+class DeviceInitHelp : public InitHelpBase<DeviceExtensionId, DeviceFeatureStructId,
+    DEVICE_EXTENSION_COUNT, DEVICE_FEATURE_STRUCT_COUNT, DEVICE_EXTENSION_DEPENDENCY_COUNT>
+{
+	DeviceInitHelp(const DeviceInitHelp&) = delete;
+	DeviceInitHelp(DeviceInitHelp&&) = delete;
+	DeviceInitHelp& operator=(const DeviceInitHelp&) = delete;
+	DeviceInitHelp& operator=(DeviceInitHelp&&) = delete;
+
+#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType) \
+    private: structName m_##structName = { (sType) }; \
+    private: structName m_##structName##Enable = { (sType) }; \
+    public: structName& Get##structName() \
+    { \
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first."); \
+        return m_##structName; \
+    } \
+    public: const structName& Get##structName() const \
+    { \
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first."); \
+        return m_##structName; \
+    }
+#define VKEFH_DEVICE_PROPERTY_STRUCT(structName, sType) \
+    private: structName m_##structName = { (sType) }; \
+    public: const structName& Get##structName() const \
+    { \
+        VKEFH_ASSERT(m_PhysicalDevicePropertiesQueried && "You need to call GetPhysicalDeviceProperties first."); \
+        return m_##structName; \
+    }
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+
+public:
+    DeviceInitHelp()
+    {
+        m_Extensions.Init(DefinitionNames<>::s_DeviceExtensions);
+
+#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)   m_FeatureStructs[(size_t)DeviceFeatureStructId::structName] = {(#structName), (sType), (VkBaseInStructure*)(&m_##structName), (VkBaseInStructure*)(&m_##structName), (uint32_t)sizeof(structName), GetFeatureBoolCount<structName>(), true, false, false, false, true, INVALID_ID, 0}; \
+    m_EnableStructPtrs[(size_t)DeviceFeatureStructId::structName] = (VkBaseInStructure*)(&m_##structName##Enable);
+#define VKEFH_DEVICE_EXTENSION_REQUIRES(extensionName, requiredExtensionName)   static_assert(GetDeviceExtensionId(extensionName) != (DeviceExtensionId)INVALID_ID && GetDeviceExtensionId(requiredExtensionName) != (DeviceExtensionId)INVALID_ID, "Extensions used in VKEFH_DEVICE_EXTENSION_REQUIRES must be specified in VkExtensionsFeatures.inl."); AddExtensionDependency((extensionName), (requiredExtensionName));
+#define VKEFH_DEVICE_EXTENSION_PROMOTED(extensionName, apiVersion)   static_assert(GetDeviceExtensionId(extensionName) != (DeviceExtensionId)INVALID_ID, "Extensions used in VKEFH_DEVICE_EXTENSION_PROMOTED must be specified in VkExtensionsFeatures.inl."); SetExtensionPromotedVersion((extensionName), (apiVersion));
+#define VKEFH_DEVICE_PROPERTY_STRUCT(structName, sType)   m_PropertyStructs[(size_t)DevicePropertyStructId::structName] = {(VkBaseInStructure*)(&m_##structName), INVALID_ID, 0, false};
+#define VKEFH_DEVICE_PROPERTY_STRUCT_REQUIRES(structName, extensionName, apiVersion)   SetPropertyStructRequirement(DevicePropertyStructId::structName, (extensionName), (apiVersion));
+#define VKEFH_DEVICE_FEATURE_STRUCT_REQUIRES(structName, extensionName, apiVersion)   SetFeatureStructRequirement(DeviceFeatureStructId::structName, (extensionName), (apiVersion));
+#define VKEFH_EXPAND_DEFINITION_FILE
+#include VKEFH_HEADER_FILE
+
+        SortExtensionDependencies();
+        // Clear padding too, so members after sType and pNext can be processed as an array of VkBool32.
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            memset(m_FeatureStructs[i].m_StructPtr, 0, m_FeatureStructs[i].m_StructSize);
+            m_FeatureStructs[i].m_StructPtr->sType = m_FeatureStructs[i].m_sType;
+        }
+        ClearRequestedFeatures();
+        ResetFeatureChain();
+    }
+
+	void Reset()
+	{
+		InitHelpBase::Reset();
+		m_PhysicalDeviceFeaturesQueried = false;
+		m_IdentityQueried = false;
+		m_QueueFamilyCount = 0;
+		m_QueueFamiliesQueried = false;
+		m_QueueRequests.fill(QueueRequest{false, 0.f});
+		m_QueuePlan.fill(QueueAssignment{INVALID_ID, INVALID_ID});
+		m_QueueCreateInfoCount = 0;
+		m_Features2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+		m_PhysicalDevicePropertiesQueried = false;
+		m_Properties2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+		m_MinimalEnable = false;
+		if(m_ChainUsesEnableCopies)
+			SwitchFeatureChain(false);
+		ClearRequestedFeatures();
+	}
+
+    // Uses vkGetPhysicalDeviceProperties2 to fetch identification of the device and its driver.
+    void GetPhysicalDeviceIdentity(VkPhysicalDevice physicalDevice)
+    {
+        QueryPhysicalDeviceIdentity(physicalDevice, m_Identity);
+        m_IdentityQueried = true;
+    }
+
+    const DeviceIdentity& GetIdentity() const
+    {
+        VKEFH_ASSERT(m_IdentityQueried && "You need to call GetPhysicalDeviceIdentity first.");
+        return m_Identity;
+    }
+
+    // Hash of device extensions and feature structures specified in VkExtensionsFeatures.inl.
+    uint64_t GetDefinitionHash() const
+    {
+        uint64_t hash = HashBytes64(nullptr, 0);
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            const char* name = m_Extensions.m_Items[i].m_Name;
+            hash = HashBytes64(name, strlen(name) + 1, hash);
+        }
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            const FeatureStruct& featureStruct = m_FeatureStructs[i];
+            hash = HashBytes64(featureStruct.m_Name, strlen(featureStruct.m_Name) + 1, hash);
+            hash = HashBytes64(&featureStruct.m_sType, sizeof(featureStruct.m_sType), hash);
+            hash = HashBytes64(&featureStruct.m_StructSize, sizeof(featureStruct.m_StructSize), hash);
+        }
+        return hash;
+    }
+
+#if VKEFH_USE_MAPPED_FILES
+    /*
+    Saves supported extensions and contents of all feature structures to a file, to be loaded
+    later with LoadCapabilityCache. Call it after EnumerateExtensions, GetPhysicalDeviceFeatures,
+    and GetPhysicalDeviceIdentity, before you make any changes to the features.
+    Use a separate file for each physical device.
+    */
+    bool SaveCapabilityCache(const char* filePath) const
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && "You need to call EnumerateExtensions first.");
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        VKEFH_ASSERT(m_IdentityQueried && "You need to call GetPhysicalDeviceIdentity first.");
+
+        std::vector<char> file(sizeof(CapabilityCacheHeader) + GetCapabilityCacheDataSize());
+        char* data = file.data() + sizeof(CapabilityCacheHeader);
+        uint32_t* extensionBits = (uint32_t*)data;
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            if(m_Extensions.m_Items[i].m_Supported)
+                extensionBits[i / 32] |= 1u << (i % 32);
+        }
+        data += (m_Extensions.m_Items.size() + 31) / 32 * sizeof(uint32_t);
+        memcpy(data, &m_Features2.features, sizeof(VkPhysicalDeviceFeatures));
+        data += sizeof(VkPhysicalDeviceFeatures);
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            const size_t size = m_FeatureStructs[i].m_StructSize - sizeof(VkBaseInStructure);
+            memcpy(data, m_FeatureStructs[i].m_StructPtr + 1, size);
+            data += size;
+        }
+
+        CapabilityCacheHeader header = {};
+        header.m_Magic = CAPABILITY_CACHE_MAGIC;
+        header.m_Version = CAPABILITY_CACHE_VERSION;
+        header.m_DefinitionHash = GetDefinitionHash();
+        header.m_Identity = m_Identity;
+        header.m_DataSize = GetCapabilityCacheDataSize();
+        header.m_DataHash = HashBytes64(file.data() + sizeof(CapabilityCacheHeader), header.m_DataSize);
+        memcpy(file.data(), &header, sizeof(header));
+        return WriteFileAtomically(filePath, file.data(), file.size());
+    }
+
+    /*
+    Loads data saved by SaveCapabilityCache, as an alternative to calling EnumerateExtensions and
+    GetPhysicalDeviceFeatures, without any calls to Vulkan. Call GetPhysicalDeviceIdentity first.
+    Returns false if the file doesn't exist or doesn't match the device, its driver version,
+    or the contents of VkExtensionsFeatures.inl - then you need to query the device normally.
+    */
+    bool LoadCapabilityCache(const char* filePath)
+    {
+        VKEFH_ASSERT(!m_ExtensionsEnumerated && "You should call EnumerateExtensions only once.");
+        VKEFH_ASSERT(!m_PhysicalDeviceFeaturesQueried && "You should call GetPhysicalDeviceFeatures only once.");
+        VKEFH_ASSERT(m_IdentityQueried && "You need to call GetPhysicalDeviceIdentity first.");
+
+        MappedFile file;
+        if(!file.Open(filePath) || file.GetSize() < sizeof(CapabilityCacheHeader))
+            return false;
+        CapabilityCacheHeader header;
+        memcpy(&header, file.GetData(), sizeof(header));
+        const char* data = (const char*)file.GetData() + sizeof(CapabilityCacheHeader);
+        if(header.m_Magic != CAPABILITY_CACHE_MAGIC ||
+            header.m_Version != CAPABILITY_CACHE_VERSION ||
+            header.m_DefinitionHash != GetDefinitionHash() ||
+            memcmp(&header.m_Identity, &m_Identity, sizeof(DeviceIdentity)) != 0 ||
+            header.m_DataSize != GetCapabilityCacheDataSize() ||
+            file.GetSize() != sizeof(CapabilityCacheHeader) + header.m_DataSize ||
+            header.m_DataHash != HashBytes64(data, header.m_DataSize))
+        {
+            return false;
+        }
+
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            uint32_t bits;
+            memcpy(&bits, data + i / 32 * sizeof(uint32_t), sizeof(bits));
+            const bool supported = (bits & (1u << (i % 32))) != 0;
+            m_Extensions.m_Items[i].m_Supported = supported;
+            m_Extensions.m_Items[i].m_Enabled = supported;
+        }
+        data += (m_Extensions.m_Items.size() + 31) / 32 * sizeof(uint32_t);
+        memcpy(&m_Features2.features, data, sizeof(VkPhysicalDeviceFeatures));
+        data += sizeof(VkPhysicalDeviceFeatures);
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            const size_t size = m_FeatureStructs[i].m_StructSize - sizeof(VkBaseInStructure);
+            memcpy(m_FeatureStructs[i].m_StructPtr + 1, data, size);
+            data += size;
+        }
+
+        m_ExtensionsEnumerated = true;
+        m_PhysicalDeviceFeaturesQueried = true;
+        return true;
+    }
+
+    // Maps the file into memory and calls LoadCapabilitiesFromJson. Returns false if the file cannot be opened.
+    bool LoadCapabilitiesFromJsonFile(const char* filePath)
+    {
+        MappedFile file;
+        if(!file.Open(filePath))
+            return false;
+        return LoadCapabilitiesFromJson((const char*)file.GetData(), file.GetSize());
+    }
+#endif // #if VKEFH_USE_MAPPED_FILES
+
+    /*
+    Loads supported extensions and contents of feature structures from a capability file in the JSON
+    format of Vulkan Profiles, e.g. as written by "vulkaninfo --json", as an alternative to calling
+    EnumerateExtensions and GetPhysicalDeviceFeatures, without any calls to Vulkan. Only extensions
+    and feature structures specified in VkExtensionsFeatures.inl are looked up. Members of feature
+    structures other than VkPhysicalDeviceFeatures are loaded only if specified using
+    VKEFH_DEVICE_FEATURE_MEMBER. Contents of all blocks under "capabilities" are merged.
+    Returns false if the JSON is malformed - then the object is left as before the call.
+    */
+    bool LoadCapabilitiesFromJson(const char* json, size_t jsonLength)
+    {
+        VKEFH_ASSERT(!m_ExtensionsEnumerated && "You should call EnumerateExtensions only once.");
+        VKEFH_ASSERT(!m_PhysicalDeviceFeaturesQueried && "You should call GetPhysicalDeviceFeatures only once.");
+        VKEFH_ASSERT(json != nullptr || jsonLength == 0);
+
+        JsonReader reader(json, jsonLength);
+        if(!ReadJsonCapabilityFile(reader))
+        {
+            // Revert to the state after construction.
+            for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+                m_Extensions.m_Items[i].m_Supported = false;
+            memset(&m_Features2.features, 0, sizeof(VkPhysicalDeviceFeatures));
+            for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+                memset(m_FeatureStructs[i].m_StructPtr + 1, 0, m_FeatureStructs[i].m_StructSize - sizeof(VkBaseInStructure));
+            return false;
+        }
+
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+            m_Extensions.m_Items[i].m_Enabled = m_Extensions.m_Items[i].m_Supported;
+        m_ExtensionsEnumerated = true;
+        m_PhysicalDeviceFeaturesQueried = true;
+        return true;
+    }
+
+    VkResult EnumerateExtensions(VkPhysicalDevice physicalDevice)
+    {
+        VKEFH_INSTRUMENT_PHASE(EnumerateExtensions);
+        VKEFH_ASSERT(m_VulkanFunctions.vkEnumerateDeviceExtensionProperties && "Vulkan function vkEnumerateDeviceExtensionProperties is not available.");
+        VKEFH_ASSERT(physicalDevice);
+        uint32_t extPropCount = 0;
+        VkResult res = m_VulkanFunctions.vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extPropCount, nullptr);
+        if(res != VK_SUCCESS)
+        {
+            return res;
+        }
+        std::vector<VkExtensionProperties> extProps{extPropCount};
+        if(extPropCount)
+        {
+            res = m_VulkanFunctions.vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extPropCount, extProps.data());
+            if(res != VK_SUCCESS)
+            {
+                return res;
+            }
+            LoadExtensions(extProps.data(), extPropCount);
+        }
+        else
+            LoadExtensions(nullptr, 0);
+        return VK_SUCCESS;
+    }
+
+    /*
+    Like EnumerateExtensions(physicalDevice), but uses memory provided by the caller instead of
+    allocating it, and needs only one call to Vulkan. Returns VK_INCOMPLETE if scratchCapacity is
+    too small to hold all the extensions - then you can call it again with a larger buffer.
+    */
+    VkResult EnumerateExtensions(VkPhysicalDevice physicalDevice, VkExtensionProperties* scratch, uint32_t scratchCapacity)
+    {
+        VKEFH_INSTRUMENT_PHASE(EnumerateExtensions);
+        VKEFH_ASSERT(m_VulkanFunctions.vkEnumerateDeviceExtensionProperties && "Vulkan function vkEnumerateDeviceExtensionProperties is not available.");
+        VKEFH_ASSERT(physicalDevice);
+        VKEFH_ASSERT(scratch);
+        uint32_t extPropCount = scratchCapacity;
+        VkResult res = m_VulkanFunctions.vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extPropCount, scratch);
+        if(res != VK_SUCCESS)
+            return res;
+        LoadExtensions(scratch, extPropCount);
+        return VK_SUCCESS;
+    }
+
+    void GetPhysicalDeviceFeatures(VkPhysicalDevice physicalDevice)
+    {
+        VKEFH_INSTRUMENT_PHASE(GetPhysicalDeviceFeatures);
+        VKEFH_ASSERT(m_VulkanFunctions.vkGetPhysicalDeviceFeatures2 && "Vulkan function vkGetPhysicalDeviceFeatures2 is not available.");
+        VKEFH_ASSERT(physicalDevice);
+        VKEFH_ASSERT(!m_PhysicalDeviceFeaturesQueried && "You should call GetPhysicalDeviceFeatures only once.");
+
+        VKEFH_ASSERT(m_Features2.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2);
+        VKEFH_ASSERT(!m_ChainUsesEnableCopies);
+        if(m_ExtensionsEnumerated)
+            UpdateAvailableFeatureStructs(false, GetStructApiVersion());
+        UpdateFeatureChain(m_Features2.pNext);
+
+        m_VulkanFunctions.vkGetPhysicalDeviceFeatures2(physicalDevice, &m_Features2);
+
+        m_PhysicalDeviceFeaturesQueried = true;
+#if VKEFH_INSTRUMENTATION
+        m_Instrumentation.m_QueryChainLength = CountLinkedFeatureStructs();
+#endif
+    }
+
+#if VKEFH_USE_THREADS
+    /*
+    Calls EnumerateExtensions(physicalDevice) and then GetPhysicalDeviceFeatures(physicalDevice)
+    on a background thread, so this work can overlap with the calling thread, e.g. creation of
+    other objects or the same work for other physical devices using separate DeviceInitHelp objects.
+    The returned future becomes ready when both have finished. Its value is the result of
+    EnumerateExtensions(). If it failed, features are not queried.
+    Don't access this object until the future is ready.
+    Available only when VKEFH_USE_THREADS is 1, which is the default.
+    */
+    std::future<VkResult> EnumerateAsync(VkPhysicalDevice physicalDevice)
+    {
+        return std::async(std::launch::async, [this, physicalDevice]() -> VkResult
+        {
+            const VkResult res = EnumerateExtensions(physicalDevice);
+            if(res != VK_SUCCESS)
+                return res;
+            GetPhysicalDeviceFeatures(physicalDevice);
+            return VK_SUCCESS;
+        });
+    }
+#endif
+
+    /*
+    Fills VkPhysicalDeviceProperties and all property structures specified in VkExtensionsFeatures.inl
+    with a single call to vkGetPhysicalDeviceProperties2. Structures whose requirements specified using
+    VKEFH_DEVICE_PROPERTY_STRUCT_REQUIRES are not met are not queried and remain zero.
+    */
+    void GetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice)
+    {
+        VKEFH_INSTRUMENT_PHASE(GetPhysicalDeviceProperties);
+        VKEFH_ASSERT(m_VulkanFunctions.vkGetPhysicalDeviceProperties2 && "Vulkan function vkGetPhysicalDeviceProperties2 is not available.");
+        VKEFH_ASSERT(physicalDevice);
+        VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        VKEFH_ASSERT(!m_PhysicalDevicePropertiesQueried && "You should call GetPhysicalDeviceProperties only once.");
+
+        VKEFH_ASSERT(m_Properties2.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2);
+        const uint32_t apiVersion = GetStructApiVersion();
+        m_Properties2.pNext = nullptr;
+        for(size_t structIndex = 0, structCount = m_PropertyStructs.size(); structIndex < structCount; ++structIndex)
+        {
+            PropertyStruct& propertyStruct = m_PropertyStructs[structIndex];
+            propertyStruct.m_Queried =
+                (propertyStruct.m_ExtensionIndex == INVALID_ID && propertyStruct.m_ApiVersion == 0) ||
+                (propertyStruct.m_ExtensionIndex != INVALID_ID && m_Extensions.IsSupported(propertyStruct.m_ExtensionIndex)) ||
+                (propertyStruct.m_ApiVersion != 0 && propertyStruct.m_ApiVersion <= apiVersion);
+            if(propertyStruct.m_Queried)
+            {
+                propertyStruct.m_StructPtr->pNext = (VkBaseInStructure*)m_Properties2.pNext;
+                m_Properties2.pNext = propertyStruct.m_StructPtr;
+            }
+        }
+
+        m_VulkanFunctions.vkGetPhysicalDeviceProperties2(physicalDevice, &m_Properties2);
+
+        m_PhysicalDevicePropertiesQueried = true;
+    }
+
+    const VkPhysicalDeviceProperties& GetProperties() const
+    {
+        VKEFH_ASSERT(m_PhysicalDevicePropertiesQueried && "You need to call GetPhysicalDeviceProperties first.");
+        return m_Properties2.properties;
+    }
+    // Returns true if given property structure was filled by GetPhysicalDeviceProperties.
+    bool IsPropertyStructQueried(DevicePropertyStructId structId) const
+    {
+        VKEFH_ASSERT(m_PhysicalDevicePropertiesQueried && "You need to call GetPhysicalDeviceProperties first.");
+        VKEFH_ASSERT((size_t)structId < m_PropertyStructs.size() && "You can query only for property structs specified in VkExtensionsFeatures.inl.");
+        return m_PropertyStructs[(size_t)structId].m_Queried;
+    }
+
+    VkPhysicalDeviceFeatures& GetFeatures()
+    {
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        return m_Features2.features;
+    }
+	const VkPhysicalDeviceFeatures& GetFeatures() const
+	{
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+		return m_Features2.features;
+	}
+
+    VkBool32& GetFeatureBit(DeviceFeatureBit bit)
+    {
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        return *(VkBool32*)((char*)GetFeatureStructPtr(bit.m_Struct) + bit.m_Offset);
+    }
+    VkBool32 GetFeatureBit(DeviceFeatureBit bit) const
+    {
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        return *(const VkBool32*)((const char*)GetFeatureStructPtr(bit.m_Struct) + bit.m_Offset);
+    }
+
+    /*
+    In minimal enable mode, features passed to device creation are kept separately from the supported ones
+    returned by GetFeatures, Get##STRUCT_NAME, and GetFeatureBit. They all start as VK_FALSE and only
+    the bits requested using RequestFeature get enabled. Enabled structures with no requested members
+    are not attached to the chain. Call it before PrepareCreation.
+    */
+    void SetMinimalEnable(bool minimalEnable) { m_MinimalEnable = minimalEnable; }
+    bool IsMinimalEnable() const { return m_MinimalEnable; }
+
+    // Requests a feature to be enabled in minimal enable mode. Returns true if it is supported, false otherwise.
+    // Requesting a feature that is not supported has no effect.
+    bool RequestFeature(DeviceFeatureBit bit, bool requested = true)
+    {
+        VKEFH_ASSERT(m_MinimalEnable && "You need to call SetMinimalEnable(true) first.");
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        const bool supported = GetFeatureBit(bit) != VK_FALSE;
+        *(VkBool32*)((char*)GetEnableStructPtr(bit.m_Struct) + bit.m_Offset) = requested && supported ? VK_TRUE : VK_FALSE;
+        return supported;
+    }
+    // Requests multiple features. Returns true if all of them are supported.
+    bool RequestFeatures(const DeviceFeatureBit* bits, size_t bitCount)
+    {
+        bool allSupported = true;
+        for(size_t i = 0; i < bitCount; ++i)
+        {
+            if(!RequestFeature(bits[i]))
+                allSupported = false;
+        }
+        return allSupported;
+    }
+    bool IsFeatureRequested(DeviceFeatureBit bit) const
+    {
+        return *(const VkBool32*)((const char*)GetEnableStructPtr(bit.m_Struct) + bit.m_Offset) != VK_FALSE;
+    }
+    void ClearRequestedFeatures()
+    {
+        m_EnableFeatures2.features = {};
+        for(size_t i = 0, count = m_EnableStructPtrs.size(); i < count; ++i)
+        {
+            memset(m_EnableStructPtrs[i] + 1, 0, m_FeatureStructs[i].m_StructSize - sizeof(VkBaseInStructure));
+        }
+    }
+
+    /*
+    Applies rules of the quirk table that match the device and its driver version, as returned by
+    GetIdentity. You can call it only after EnumerateExtensions, GetPhysicalDeviceFeatures, and
+    GetPhysicalDeviceIdentity, before enabling extensions and features you need. Returns number of rules applied.
+    */
+    uint32_t ApplyDriverQuirks(const DriverQuirkTable& quirks)
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        VKEFH_ASSERT(m_IdentityQueried && "You need to call GetPhysicalDeviceIdentity first.");
+        // Rules for the device, for any device of the vendor, for the device ID of any vendor, and for any device at all.
+        const uint32_t keys[4][2] = {
+            { m_Identity.m_VendorID, m_Identity.m_DeviceID },
+            { m_Identity.m_VendorID, 0 },
+            { 0, m_Identity.m_DeviceID },
+            { 0, 0 } };
+        uint32_t appliedCount = 0;
+        for(size_t keyIndex = 0; keyIndex < 4; ++keyIndex)
+        {
+            // IDs that are 0 make some keys equal. Rules under them must be applied only once.
+            bool duplicate = false;
+            for(size_t prevIndex = 0; prevIndex < keyIndex; ++prevIndex)
+                duplicate = duplicate || (keys[keyIndex][0] == keys[prevIndex][0] && keys[keyIndex][1] == keys[prevIndex][1]);
+            if(duplicate)
+                continue;
+            const DriverQuirk* begin;
+            const DriverQuirk* end;
+            quirks.FindQuirks(keys[keyIndex][0], keys[keyIndex][1], begin, end);
+            for(const DriverQuirk* quirk = begin; quirk != end; ++quirk)
+            {
+                if(m_Identity.m_DriverVersion >= quirk->m_MinDriverVersion &&
+                    m_Identity.m_DriverVersion <= quirk->m_MaxDriverVersion)
+                {
+                    ApplyDriverQuirk(*quirk);
+                    ++appliedCount;
+                }
+            }
+        }
+        return appliedCount;
+    }
+
+    /*
+    Operations on whole capabilities of two physical devices: supported extensions, VkPhysicalDeviceFeatures,
+    and all feature structures. Both objects need to have EnumerateExtensions and GetPhysicalDeviceFeatures
+    called. Members of feature structures are processed as contiguous arrays of VkBool32.
+    Features requested using RequestFeature that are no longer supported are cancelled,
+    so minimal enable mode doesn't request them from the device.
+    */
+
+    // Leaves only extensions and features supported by both this and other device.
+    // Extensions that are no longer supported get disabled. Use it for a device group or to find
+    // capabilities common to multiple GPUs, then call PrepareCreation.
+    void IntersectCapabilities(const DeviceInitHelp& other)
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && other.m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && other.m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            m_Extensions.m_Items[i].m_Supported = m_Extensions.m_Items[i].m_Supported && other.m_Extensions.m_Items[i].m_Supported;
+            m_Extensions.m_Items[i].m_Enabled = m_Extensions.m_Items[i].m_Enabled && m_Extensions.m_Items[i].m_Supported;
+        }
+        m_Extensions.m_Dirty = true;
+        for(uint32_t structIndex = 0; structIndex <= DEVICE_FEATURE_STRUCT_COUNT; ++structIndex)
+        {
+            size_t boolCount;
+            VkBool32* const dst = GetFeatureBools((DeviceFeatureStructId)structIndex, boolCount);
+            const VkBool32* const src = other.GetFeatureBools((DeviceFeatureStructId)structIndex, boolCount);
+            VkBool32* const requested = GetEnableFeatureBools((DeviceFeatureStructId)structIndex);
+            for(size_t i = 0; i < boolCount; ++i)
+            {
+                dst[i] = dst[i] && src[i] ? VK_TRUE : VK_FALSE;
+                requested[i] = requested[i] && dst[i] ? VK_TRUE : VK_FALSE;
+            }
+        }
+    }
+    // Leaves only extensions and features supported by this device but not by other device.
+    // Extensions that are no longer supported get disabled.
+    void SubtractCapabilities(const DeviceInitHelp& other)
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && other.m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && other.m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            m_Extensions.m_Items[i].m_Supported = m_Extensions.m_Items[i].m_Supported && !other.m_Extensions.m_Items[i].m_Supported;
+            m_Extensions.m_Items[i].m_Enabled = m_Extensions.m_Items[i].m_Enabled && m_Extensions.m_Items[i].m_Supported;
+        }
+        m_Extensions.m_Dirty = true;
+        for(uint32_t structIndex = 0; structIndex <= DEVICE_FEATURE_STRUCT_COUNT; ++structIndex)
+        {
+            size_t boolCount;
+            VkBool32* const dst = GetFeatureBools((DeviceFeatureStructId)structIndex, boolCount);
+            const VkBool32* const src = other.GetFeatureBools((DeviceFeatureStructId)structIndex, boolCount);
+            VkBool32* const requested = GetEnableFeatureBools((DeviceFeatureStructId)structIndex);
+            for(size_t i = 0; i < boolCount; ++i)
+            {
+                dst[i] = dst[i] && !src[i] ? VK_TRUE : VK_FALSE;
+                requested[i] = requested[i] && dst[i] ? VK_TRUE : VK_FALSE;
+            }
+        }
+    }
+    // Returns true if every extension and feature supported by this device is also supported by other device.
+    bool IsCapabilitySubsetOf(const DeviceInitHelp& other) const
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && other.m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && other.m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            if(m_Extensions.m_Items[i].m_Supported && !other.m_Extensions.m_Items[i].m_Supported)
+                return false;
+        }
+        for(uint32_t structIndex = 0; structIndex <= DEVICE_FEATURE_STRUCT_COUNT; ++structIndex)
+        {
+            size_t boolCount;
+            const VkBool32* const a = GetFeatureBools((DeviceFeatureStructId)structIndex, boolCount);
+            const VkBool32* const b = other.GetFeatureBools((DeviceFeatureStructId)structIndex, boolCount);
+            for(size_t i = 0; i < boolCount; ++i)
+            {
+                if(a[i] && !b[i])
+                    return false;
+            }
+        }
+        return true;
+    }
+    // Returns number of supported extensions plus number of features equal to VK_TRUE.
+    uint32_t CountCapabilities() const
+    {
+        VKEFH_ASSERT(m_ExtensionsEnumerated && "You should call EnumerateExtensions first.");
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        uint32_t result = 0;
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            if(m_Extensions.m_Items[i].m_Supported)
+                ++result;
+        }
+        for(uint32_t structIndex = 0; structIndex <= DEVICE_FEATURE_STRUCT_COUNT; ++structIndex)
+        {
+            size_t boolCount;
+            const VkBool32* const bools = GetFeatureBools((DeviceFeatureStructId)structIndex, boolCount);
+            for(size_t i = 0; i < boolCount; ++i)
+            {
+                if(bools[i])
+                    ++result;
+            }
+        }
+        return result;
+    }
+
+    /*
+    Returns VK_ERROR_EXTENSION_NOT_PRESENT or VK_ERROR_FEATURE_NOT_PRESENT if an extension or feature
+    specified as required in VkExtensionsFeatures.inl is not supported. This is checked before doing
+    any other work, so then the object is left unchanged.
+    */
+    VkResult PrepareCreation()
+    {
+        VKEFH_INSTRUMENT_PHASE(PrepareCreation);
+        VKEFH_ASSERT(m_ExtensionsEnumerated && "You need to call EnumerateExtensions first.");
+        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+
+        const VkResult res = CheckRequiredItems();
+        if(res != VK_SUCCESS)
+            return res;
+
+        EnableRequiredItems();
+        PrepareEnabledExtensionNames();
+        UpdateAvailableFeatureStructs(true, GetStructApiVersion());
+
+        VKEFH_ASSERT(m_Features2.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2);
+        if(m_MinimalEnable != m_ChainUsesEnableCopies)
+            SwitchFeatureChain(m_MinimalEnable);
+        UpdateEmptyFeatureStructs();
+        UpdateFeatureChain(m_ChainUsesEnableCopies ? m_EnableFeatures2.pNext : m_Features2.pNext);
+        
+        m_CreationPrepared = true;
+#if VKEFH_INSTRUMENTATION
+        m_Instrumentation.m_Extensions.m_Enabled = m_Extensions.m_EnabledItemCount;
+        m_Instrumentation.m_CreationChainLength = CountLinkedFeatureStructs();
+#endif
+        return VK_SUCCESS;
+    }
+
+    const void* GetFeaturesChain() const
+    {
+        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
+        return m_ChainUsesEnableCopies ? &m_EnableFeatures2 : &m_Features2;
+    }
+
+    /*
+    Returns 64-bit fingerprint of capabilities the device is created with, to be used as a key of caches
+    of compiled shader and pipeline variants. It covers extensions enabled by the last PrepareCreation,
+    VkBool32 members of VkPhysicalDeviceFeatures and of all feature structures passed to creation,
+    the definition file (GetDefinitionHash), and the device and driver (GetIdentity).
+    The value is the same in every process for the same inputs. It uses a fast non-cryptographic hash.
+    You can call it only after PrepareCreation and GetPhysicalDeviceIdentity.
+    */
+    uint64_t GetCapabilityFingerprint() const
+    {
+        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
+        VKEFH_ASSERT(m_IdentityQueried && "You need to call GetPhysicalDeviceIdentity first.");
+        uint64_t hash = HashWord64(GetDefinitionHash());
+
+        hash = HashWord64((uint64_t)m_Identity.m_VendorID << 32 | m_Identity.m_DeviceID, hash);
+        hash = HashWord64((uint64_t)m_Identity.m_DriverVersion << 32 | m_Identity.m_ApiVersion, hash);
+        const uint8_t* const uuids[] = { m_Identity.m_DeviceUUID, m_Identity.m_PipelineCacheUUID };
+        for(size_t uuidIndex = 0; uuidIndex < 2; ++uuidIndex)
+        {
+            for(size_t first = 0; first < VK_UUID_SIZE; first += 8)
+            {
+                uint64_t word = 0;
+                for(size_t i = 0; i < 8; ++i)
+                    word |= (uint64_t)uuids[uuidIndex][first + i] << (i * 8);
+                hash = HashWord64(word, hash);
+            }
+        }
+
+        // Enabled extensions and linked structures as bit masks. Their indices are covered by the definition hash.
+        uint64_t word = 0;
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            if(m_Extensions.m_Items[i].m_Enabled)
+                word |= 1ull << (i % 64);
+            if(i % 64 == 63 || i + 1 == count)
+            {
+                hash = HashWord64(word, hash);
+                word = 0;
+            }
+        }
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            if(m_FeatureStructs[i].m_Linked)
+                word |= 1ull << (i % 64);
+            if(i % 64 == 63 || i + 1 == count)
+            {
+                hash = HashWord64(word, hash);
+                word = 0;
+            }
+        }
+
+        const VkPhysicalDeviceFeatures& features = m_ChainUsesEnableCopies ? m_EnableFeatures2.features : m_Features2.features;
+        hash = HashBools64((const VkBool32*)&features, sizeof(features) / sizeof(VkBool32), hash);
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            const FeatureStruct& featureStruct = m_FeatureStructs[i];
+            if(featureStruct.m_Linked)
+            {
+                hash = HashBools64((const VkBool32*)(featureStruct.m_LinkPtr + 1), featureStruct.m_BoolCount, hash);
+            }
+        }
+        return FinalizeHash64(hash);
+    }
+
+    /*
+    Checks whether the device can be created again with the same parameters, e.g. after VK_ERROR_DEVICE_LOST,
+    without calling Reset and negotiating extensions and features again. Results of the last PrepareCreation
+    and PlanQueues are kept, so you can pass them to vkCreateDevice immediately. To check that physicalDevice
+    is still the same device with the same driver, its identity is queried with a single call to
+    vkGetPhysicalDeviceProperties2 and compared with the one from GetPhysicalDeviceIdentity.
+    Pass VK_NULL_HANDLE to skip the check. Returns VK_ERROR_INCOMPATIBLE_DRIVER if the identity changed -
+    then you need to call Reset and query the device again.
+    */
+    VkResult PrepareRecreation(VkPhysicalDevice physicalDevice)
+    {
+        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
+        if(physicalDevice != VK_NULL_HANDLE)
+        {
+            VKEFH_ASSERT(m_IdentityQueried && "You need to call GetPhysicalDeviceIdentity first.");
+            DeviceIdentity identity;
+            QueryPhysicalDeviceIdentity(physicalDevice, identity);
+            if(memcmp(&identity, &m_Identity, sizeof(DeviceIdentity)) != 0)
+                return VK_ERROR_INCOMPATIBLE_DRIVER;
+        }
+        return VK_SUCCESS;
+    }
+
+    /*
+    Returns snapshot of extensions and features enabled by the last PrepareCreation, exactly as passed
+    to device creation. It stays unchanged when this object is modified or destroyed.
+    */
+    DeviceCapabilities GetCapabilities() const
+    {
+        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
+        DeviceCapabilities result;
+        for(size_t i = 0, count = m_Extensions.m_Items.size(); i < count; ++i)
+        {
+            if(m_Extensions.m_Items[i].m_Enabled)
+                result.m_ExtensionBits[i / 32] |= 1u << (i % 32);
+        }
+        result.m_Structs.m_VkPhysicalDeviceFeatures = m_ChainUsesEnableCopies ? m_EnableFeatures2.features : m_Features2.features;
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            const FeatureStruct& featureStruct = m_FeatureStructs[i];
+            if(!featureStruct.m_Linked)
+                continue;
+            result.m_FeatureStructBits[i / 32] |= 1u << (i % 32);
+            char* const dst = (char*)&result.m_Structs + DeviceFeatureStructOffsets<>::s_Offsets[i];
+            memcpy(dst, featureStruct.m_LinkPtr, featureStruct.m_StructSize);
+            ((VkBaseOutStructure*)dst)->pNext = nullptr;
+        }
+        // Required items were enabled by PrepareCreation. Folding them in keeps queries about them to a single read.
+        for(const DeviceExtensionId* ext = DefinitionRequirements<>::s_DeviceExtensions; *ext != (DeviceExtensionId)INVALID_ID; ++ext)
+            result.m_ExtensionBits[(uint32_t)*ext / 32] |= 1u << ((uint32_t)*ext % 32);
+        for(const DeviceFeatureBit* bit = DefinitionRequirements<>::s_DeviceFeatures; bit->m_Struct != (DeviceFeatureStructId)INVALID_ID; ++bit)
+        {
+            *(VkBool32*)((char*)&result.m_Structs + DeviceFeatureStructOffsets<>::s_Offsets[(uint32_t)bit->m_Struct] + bit->m_Offset) = VK_TRUE;
+            if(bit->m_Struct != DeviceFeatureStructId::VkPhysicalDeviceFeatures)
+                result.m_FeatureStructBits[(uint32_t)bit->m_Struct / 32] |= 1u << ((uint32_t)bit->m_Struct % 32);
+        }
+        return result;
+    }
+
+    // Requests a queue of given role to be planned by PlanQueues, with given priority in range 0..1.
+    void RequestQueue(QueueRole role, float priority = 1.0f)
+    {
+        VKEFH_ASSERT(role < QueueRole::Count);
+        VKEFH_ASSERT(priority >= 0.f && priority <= 1.f);
+        m_QueueRequests[(size_t)role] = {true, priority};
+    }
+
+    /*
+    Assigns requested queue roles to queue families, preferring families with fewest capabilities
+    and different families for different roles, so async compute and transfer can overlap with graphics.
+    Queue family properties are queried only on the first call. surface is needed only if QueueRole::Present
+    was requested. Returns VK_ERROR_FEATURE_NOT_PRESENT if a requested role cannot be satisfied.
+    */
+    VkResult PlanQueues(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface = VK_NULL_HANDLE)
+    {
+        VKEFH_ASSERT(m_VulkanFunctions.vkGetPhysicalDeviceQueueFamilyProperties && "Vulkan function vkGetPhysicalDeviceQueueFamilyProperties is not available.");
+        VKEFH_ASSERT(physicalDevice);
+        if(!m_QueueFamiliesQueried)
+        {
+            m_QueueFamilyCount = MAX_QUEUE_FAMILY_COUNT;
+            m_VulkanFunctions.vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &m_QueueFamilyCount, m_QueueFamilies.data());
+            m_QueueFamiliesQueried = true;
+        }
+
+        uint32_t presentFamilyMask = 0;
+        if(m_QueueRequests[(size_t)QueueRole::Present].m_Requested)
+        {
+            VKEFH_ASSERT(m_VulkanFunctions.vkGetPhysicalDeviceSurfaceSupportKHR && "Vulkan function vkGetPhysicalDeviceSurfaceSupportKHR is not available.");
+            VKEFH_ASSERT(surface != VK_NULL_HANDLE && "You need to pass surface to PlanQueues when QueueRole::Present is requested.");
+            for(uint32_t familyIndex = 0; familyIndex < m_QueueFamilyCount; ++familyIndex)
+            {
+                VkBool32 supported = VK_FALSE;
+                const VkResult res = m_VulkanFunctions.vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, familyIndex, surface, &supported);
+                if(res != VK_SUCCESS)
+                    return res;
+                if(supported)
+                    presentFamilyMask |= 1u << familyIndex;
+            }
+        }
+
+        m_QueuePlan.fill(QueueAssignment{INVALID_ID, INVALID_ID});
+        m_QueueCreateInfoCount = 0;
+        std::array<uint32_t, MAX_QUEUE_FAMILY_COUNT> familyQueueCounts;
+        familyQueueCounts.fill(0);
+
+        const VkQueueFlags anyQueueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+        const uint32_t allFamilyMask = UINT32_MAX;
+        if(m_QueueRequests[(size_t)QueueRole::Graphics].m_Requested &&
+            !AssignQueue(QueueRole::Graphics, VK_QUEUE_GRAPHICS_BIT, allFamilyMask, familyQueueCounts))
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        if(m_QueueRequests[(size_t)QueueRole::AsyncCompute].m_Requested &&
+            !AssignQueue(QueueRole::AsyncCompute, VK_QUEUE_COMPUTE_BIT, allFamilyMask, familyQueueCounts))
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        // Graphics and compute queues support transfer even if VK_QUEUE_TRANSFER_BIT is not reported.
+        if(m_QueueRequests[(size_t)QueueRole::Transfer].m_Requested &&
+            !AssignQueue(QueueRole::Transfer, anyQueueFlags, allFamilyMask, familyQueueCounts))
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        if(m_QueueRequests[(size_t)QueueRole::Present].m_Requested)
+        {
+            // Presenting from the graphics queue avoids ownership transfers of swapchain images.
+            const QueueAssignment& graphics = m_QueuePlan[(size_t)QueueRole::Graphics];
+            if(graphics.m_FamilyIndex != INVALID_ID && (presentFamilyMask & (1u << graphics.m_FamilyIndex)) != 0)
+                m_QueuePlan[(size_t)QueueRole::Present] = graphics;
+            else if(!AssignQueue(QueueRole::Present, 0, presentFamilyMask, familyQueueCounts))
+                return VK_ERROR_FEATURE_NOT_PRESENT;
+        }
+
+        // One create info per family, in order of first use, with priorities of its queues stored contiguously.
+        uint32_t priorityCount = 0;
+        for(uint32_t role = 0; role < QUEUE_ROLE_COUNT; ++role)
+        {
+            const QueueAssignment& assignment = m_QueuePlan[role];
+            if(assignment.m_FamilyIndex == INVALID_ID)
+                continue;
+            uint32_t createInfoIndex = 0;
+            while(createInfoIndex < m_QueueCreateInfoCount &&
+                m_QueueCreateInfos[createInfoIndex].queueFamilyIndex != assignment.m_FamilyIndex)
+                ++createInfoIndex;
+            if(createInfoIndex == m_QueueCreateInfoCount)
+            {
+                VkDeviceQueueCreateInfo& createInfo = m_QueueCreateInfos[m_QueueCreateInfoCount++];
+                createInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+                createInfo.queueFamilyIndex = assignment.m_FamilyIndex;
+                createInfo.queueCount = familyQueueCounts[assignment.m_FamilyIndex];
+                createInfo.pQueuePriorities = m_QueuePriorities.data() + priorityCount;
+                for(uint32_t i = 0; i < createInfo.queueCount; ++i)
+                    m_QueuePriorities[priorityCount + i] = 0.f;
+                priorityCount += createInfo.queueCount;
+            }
+            // A queue shared by multiple roles gets the highest of their priorities.
+            float& priority = m_QueuePriorities[(m_QueueCreateInfos[createInfoIndex].pQueuePriorities - m_QueuePriorities.data()) + assignment.m_QueueIndex];
+            priority = std::max(priority, m_QueueRequests[role].m_Priority);
+        }
+        return VK_SUCCESS;
+    }
+
+    // Returns index of the queue family assigned to given role by PlanQueues, or INVALID_ID if the role was not requested.
+    uint32_t GetQueueFamilyIndex(QueueRole role) const
+    {
+        VKEFH_ASSERT(role < QueueRole::Count);
+        return m_QueuePlan[(size_t)role].m_FamilyIndex;
+    }
+    // Returns index of the queue within its family assigned to given role by PlanQueues, to be passed to vkGetDeviceQueue.
+    uint32_t GetQueueIndex(QueueRole role) const
+    {
+        VKEFH_ASSERT(role < QueueRole::Count);
+        return m_QueuePlan[(size_t)role].m_QueueIndex;
+    }
+    uint32_t GetQueueCreateInfoCount() const
+    {
+        return m_QueueCreateInfoCount;
+    }
+    const VkDeviceQueueCreateInfo* GetQueueCreateInfos() const
+    {
+        return m_QueueCreateInfoCount > 0 ? m_QueueCreateInfos.data() : nullptr;
+    }
+    uint32_t GetQueueFamilyCount() const
+    {
+        VKEFH_ASSERT(m_QueueFamiliesQueried && "You need to call PlanQueues first.");
+        return m_QueueFamilyCount;
+    }
+    const VkQueueFamilyProperties& GetQueueFamilyProperties(uint32_t familyIndex) const
+    {
+        VKEFH_ASSERT(m_QueueFamiliesQueried && "You need to call PlanQueues first.");
+        VKEFH_ASSERT(familyIndex < m_QueueFamilyCount);
+        return m_QueueFamilies[familyIndex];
+    }
+
+private:
+    static const uint32_t CAPABILITY_CACHE_MAGIC = 0x43464556; // "VEFC"
+    static const uint32_t CAPABILITY_CACHE_VERSION = 1;
+    struct CapabilityCacheHeader
+    {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        uint64_t m_DefinitionHash;
+        DeviceIdentity m_Identity;
+        uint32_t m_DataSize;
+        uint32_t m_Padding;
+        uint64_t m_DataHash;
+    };
+
+    bool m_PhysicalDeviceFeaturesQueried = false;
+    bool m_IdentityQueried = false;
+
+    static const uint32_t QUEUE_ROLE_COUNT = (uint32_t)QueueRole::Count;
+    struct QueueRequest
+    {
+        bool m_Requested;
+        float m_Priority;
+    };
+    struct QueueAssignment
+    {
+        uint32_t m_FamilyIndex;
+        uint32_t m_QueueIndex;
+    };
+    bool m_QueueFamiliesQueried = false;
+    uint32_t m_QueueFamilyCount = 0;
+    std::array<VkQueueFamilyProperties, MAX_QUEUE_FAMILY_COUNT> m_QueueFamilies;
+    std::array<QueueRequest, QUEUE_ROLE_COUNT> m_QueueRequests = {};
+    std::array<QueueAssignment, QUEUE_ROLE_COUNT> m_QueuePlan = {{
+        {INVALID_ID, INVALID_ID}, {INVALID_ID, INVALID_ID}, {INVALID_ID, INVALID_ID}, {INVALID_ID, INVALID_ID}}};
+    // Every role needs at most one queue, so there are at most QUEUE_ROLE_COUNT create infos and priorities.
+    uint32_t m_QueueCreateInfoCount = 0;
+    std::array<VkDeviceQueueCreateInfo, QUEUE_ROLE_COUNT> m_QueueCreateInfos;
+    std::array<float, QUEUE_ROLE_COUNT> m_QueuePriorities;
+    DeviceIdentity m_Identity = {};
+    VkPhysicalDeviceFeatures2 m_Features2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+
+    struct PropertyStruct
+    {
+        VkBaseInStructure* m_StructPtr;
+        // Device extension that needs to be supported to query the structure, or INVALID_ID.
+        uint32_t m_ExtensionIndex;
+        // Vulkan version that is enough to query the structure, or 0.
+        uint32_t m_ApiVersion;
+        bool m_Queried;
+    };
+    bool m_PhysicalDevicePropertiesQueried = false;
+    VkPhysicalDeviceProperties2 m_Properties2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+    std::array<PropertyStruct, DEVICE_PROPERTY_STRUCT_COUNT> m_PropertyStructs;
+
+    bool m_MinimalEnable = false;
+    // Whether the pNext chain currently links copies of feature structures from m_EnableStructPtrs.
+    bool m_ChainUsesEnableCopies = false;
+    VkPhysicalDeviceFeatures2 m_EnableFeatures2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+    std::array<VkBaseInStructure*, DEVICE_FEATURE_STRUCT_COUNT> m_EnableStructPtrs;
+
+    void QueryPhysicalDeviceIdentity(VkPhysicalDevice physicalDevice, DeviceIdentity& outIdentity) const
+    {
+        VKEFH_ASSERT(m_VulkanFunctions.vkGetPhysicalDeviceProperties2 && "Vulkan function vkGetPhysicalDeviceProperties2 is not available.");
+        VKEFH_ASSERT(physicalDevice);
+        VkPhysicalDeviceIDProperties idProps = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES };
+        VkPhysicalDeviceProperties2 props2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+        props2.pNext = &idProps;
+        m_VulkanFunctions.vkGetPhysicalDeviceProperties2(physicalDevice, &props2);
+
+        outIdentity.m_VendorID = props2.properties.vendorID;
+        outIdentity.m_DeviceID = props2.properties.deviceID;
+        outIdentity.m_DriverVersion = props2.properties.driverVersion;
+        outIdentity.m_ApiVersion = props2.properties.apiVersion;
+        memcpy(outIdentity.m_DeviceUUID, idProps.deviceUUID, VK_UUID_SIZE);
+        memcpy(outIdentity.m_PipelineCacheUUID, props2.properties.pipelineCacheUUID, VK_UUID_SIZE);
+    }
+
+    // Size of data following CapabilityCacheHeader: bits of supported extensions,
+    // VkPhysicalDeviceFeatures, then all feature structures without sType and pNext.
+    uint32_t GetCapabilityCacheDataSize() const
+    {
+        size_t size = (m_Extensions.m_Items.size() + 31) / 32 * sizeof(uint32_t) + sizeof(VkPhysicalDeviceFeatures);
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+            size += m_FeatureStructs[i].m_StructSize - sizeof(VkBaseInStructure);
+        return (uint32_t)size;
+    }
+
+    void* GetFeatureStructPtr(DeviceFeatureStructId structId)
+    {
+        if(structId == DeviceFeatureStructId::VkPhysicalDeviceFeatures)
+            return &m_Features2.features;
+        VKEFH_ASSERT((size_t)structId < m_FeatureStructs.size() && "You can query only for feature structs specified in VkExtensionsFeatures.inl.");
+        return m_FeatureStructs[(size_t)structId].m_StructPtr;
+    }
+    const void* GetFeatureStructPtr(DeviceFeatureStructId structId) const
+    {
+        return const_cast<DeviceInitHelp*>(this)->GetFeatureStructPtr(structId);
+    }
+
+    /*
+    Assigns a queue to given role from the family that has any of anyOfFlags (or any family if 0)
+    and is in familyMask. Prefers families not used by other roles yet, then those with fewest capabilities.
+    Allocates a new queue in the family if it has one left, otherwise shares the last one.
+    */
+    bool AssignQueue(QueueRole role, VkQueueFlags anyOfFlags, uint32_t familyMask,
+        std::array<uint32_t, MAX_QUEUE_FAMILY_COUNT>& familyQueueCounts)
+    {
+        const VkQueueFlags capabilityFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT | VK_QUEUE_SPARSE_BINDING_BIT;
+        uint32_t bestFamilyIndex = INVALID_ID;
+        uint32_t bestCost = UINT32_MAX;
+        for(uint32_t familyIndex = 0; familyIndex < m_QueueFamilyCount; ++familyIndex)
+        {
+            const VkQueueFamilyProperties& family = m_QueueFamilies[familyIndex];
+            if((familyMask & (1u << familyIndex)) == 0 || family.queueCount == 0 ||
+                (anyOfFlags != 0 && (family.queueFlags & anyOfFlags) == 0))
+                continue;
+            uint32_t cost = 0;
+            for(VkQueueFlags flags = family.queueFlags & capabilityFlags; flags != 0; flags &= flags - 1)
+                ++cost;
+            if(familyQueueCounts[familyIndex] > 0)
+                cost += 16;
+            if(cost < bestCost)
+            {
+                bestCost = cost;
+                bestFamilyIndex = familyIndex;
+            }
+        }
+        if(bestFamilyIndex == INVALID_ID)
+            return false;
+        uint32_t& queueCount = familyQueueCounts[bestFamilyIndex];
+        if(queueCount < m_QueueFamilies[bestFamilyIndex].queueCount)
+            ++queueCount;
+        m_QueuePlan[(size_t)role] = {bestFamilyIndex, queueCount - 1};
+        return true;
+    }
 
-#undef VKEFH_INSTANCE_EXTENSION
-#undef VKEFH_INSTANCE_LAYER
-#undef VKEFH_INSTANCE_FEATURE_STRUCT
-#undef VKEFH_DEVICE_EXTENSION
-#undef VKEFH_DEVICE_FEATURE_STRUCT
+    // Vulkan version that decides whether structures that are part of core API are used:
+    // the target API version or, until it is set, apiVersion of the physical device if it was
+    // already fetched by GetPhysicalDeviceIdentity or GetPhysicalDeviceProperties. Otherwise 0.
+    uint32_t GetStructApiVersion() const
+    {
+        if(m_TargetApiVersion != 0)
+            return m_TargetApiVersion;
+        if(m_IdentityQueried)
+            return m_Identity.m_ApiVersion;
+        return m_PhysicalDevicePropertiesQueried ? m_Properties2.properties.apiVersion : 0;
     }
 
-	void Reset()
-	{
-		InitHelpBase::Reset();
-		m_LayersEnumerated = false;
-		m_Layers.Reset();
-		m_FeaturesChain = nullptr;
-	}
+    // Whether the extension is promoted to the target API version, or is supported together with all extensions it requires.
+    bool IsExtensionUsable(uint32_t extIndex) const
+    {
+        const auto& item = m_Extensions.m_Items[extIndex];
+        if(item.m_PromotedVersion != 0 && item.m_PromotedVersion <= m_TargetApiVersion)
+            return true;
+        if(!item.m_Supported)
+            return false;
+        for(size_t i = 0; i < m_ExtensionDependencyCount; ++i)
+        {
+            if(m_ExtensionDependencies[i].m_Extension == extIndex && !IsExtensionUsable(m_ExtensionDependencies[i].m_RequiredExtension))
+                return false;
+        }
+        return true;
+    }
+    // Whether the feature structure is part of core API in the version used, so it doesn't need its extension.
+    bool IsFeatureStructCore(const FeatureStruct& featureStruct) const
+    {
+        return (featureStruct.m_ExtensionIndex == INVALID_ID && featureStruct.m_ApiVersion == 0) ||
+            (featureStruct.m_ApiVersion != 0 && featureStruct.m_ApiVersion <= GetStructApiVersion());
+    }
 
-    VkResult EnumerateExtensions()
+    /*
+    Checks that extensions and features specified using VKEFH_DEVICE_EXTENSION_REQUIRED and
+    VKEFH_DEVICE_FEATURE_REQUIRED are supported and can be enabled, without modifying anything.
+    */
+    VkResult CheckRequiredItems() const
     {
-        uint32_t extPropCount = 0;
-        VkResult res = vkEnumerateInstanceExtensionProperties(nullptr, &extPropCount, nullptr);
-        if(res != VK_SUCCESS)
-            return res;
-        if(extPropCount)
+        for(const DeviceExtensionId* ext = DefinitionRequirements<>::s_DeviceExtensions; *ext != (DeviceExtensionId)INVALID_ID; ++ext)
         {
-            std::vector<VkExtensionProperties> extProps(extPropCount);
-            res = vkEnumerateInstanceExtensionProperties(nullptr, &extPropCount, extProps.data());
-            if(res != VK_SUCCESS)
-                return res;
-            LoadExtensions(extProps.data(), extPropCount);
+            if(!IsExtensionUsable((uint32_t)*ext))
+                return VK_ERROR_EXTENSION_NOT_PRESENT;
+        }
+        for(const DeviceFeatureBit* bit = DefinitionRequirements<>::s_DeviceFeatures; bit->m_Struct != (DeviceFeatureStructId)INVALID_ID; ++bit)
+        {
+            if(GetFeatureBit(*bit) == VK_FALSE)
+                return VK_ERROR_FEATURE_NOT_PRESENT;
+            if(bit->m_Struct == DeviceFeatureStructId::VkPhysicalDeviceFeatures)
+                continue;
+            const FeatureStruct& featureStruct = m_FeatureStructs[(size_t)bit->m_Struct];
+            if(!IsFeatureStructCore(featureStruct) &&
+                (featureStruct.m_ExtensionIndex == INVALID_ID || !IsExtensionUsable(featureStruct.m_ExtensionIndex)))
+                return VK_ERROR_FEATURE_NOT_PRESENT;
         }
         return VK_SUCCESS;
     }
 
-    VkResult EnumerateLayers()
+    /*
+    Makes sure extensions and features that passed CheckRequiredItems are enabled, also if they were
+    disabled by the user, together with extensions that structures of required features come from.
+    */
+    void EnableRequiredItems()
     {
-        VKEFH_ASSERT(!m_LayersEnumerated && "You should call EnumerateLayers only once.");
-        uint32_t layerPropCount = 0;
-        VkResult res = vkEnumerateInstanceLayerProperties(&layerPropCount, nullptr);
-        if(res != VK_SUCCESS)
-            return res;
-        if(layerPropCount)
+        for(const DeviceExtensionId* ext = DefinitionRequirements<>::s_DeviceExtensions; *ext != (DeviceExtensionId)INVALID_ID; ++ext)
         {
-            std::vector<VkLayerProperties> layerProps(layerPropCount);
-            res = vkEnumerateInstanceLayerProperties(&layerPropCount, layerProps.data());
-            if(res != VK_SUCCESS)
-                return res;
-            LoadLayers(layerProps.data(), layerPropCount);
+            m_Extensions.Enable((uint32_t)*ext, true);
+        }
+        for(const DeviceFeatureBit* bit = DefinitionRequirements<>::s_DeviceFeatures; bit->m_Struct != (DeviceFeatureStructId)INVALID_ID; ++bit)
+        {
+            if(bit->m_Struct != DeviceFeatureStructId::VkPhysicalDeviceFeatures)
+            {
+                const FeatureStruct& featureStruct = m_FeatureStructs[(size_t)bit->m_Struct];
+                if(!IsFeatureStructCore(featureStruct))
+                    m_Extensions.Enable(featureStruct.m_ExtensionIndex, true);
+                EnableFeatureStruct(bit->m_Struct, true);
+            }
+            if(m_MinimalEnable)
+                RequestFeature(*bit);
         }
-        m_LayersEnumerated = true;
-        return VK_SUCCESS;
     }
 
-    bool IsLayerSupported(const char* layerName) const
+    /*
+    Disable makes the extension not supported, or sets the feature to VK_FALSE as if it was not supported.
+    NotPreferred disables the extension, which can still be enabled using EnableExtension, or sets the
+    feature to VK_FALSE, which can still be set back to VK_TRUE. Required items are not affected by NotPreferred.
+    Call SetMinimalEnable before, if you use it.
+    */
+    void ApplyDriverQuirk(const DriverQuirk& quirk)
     {
-        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
-        return m_Layers.IsSupported(layerName);
+        if(quirk.m_Extension != (DeviceExtensionId)INVALID_ID)
+        {
+            if(quirk.m_Action == DriverQuirkAction::Disable)
+                m_Extensions.m_Items[(size_t)quirk.m_Extension].m_Supported = false;
+            else if(IsDeviceExtensionRequired(quirk.m_Extension))
+                return;
+            EnableExtension(quirk.m_Extension, false);
+            return;
+        }
+        if(quirk.m_Action == DriverQuirkAction::Disable)
+        {
+            GetFeatureBit(quirk.m_Feature) = VK_FALSE;
+            *(VkBool32*)((char*)GetEnableStructPtr(quirk.m_Feature.m_Struct) + quirk.m_Feature.m_Offset) = VK_FALSE;
+        }
+        // In minimal enable mode, features are not enabled unless requested anyway.
+        else if(!m_MinimalEnable && !IsDeviceFeatureRequired(quirk.m_Feature))
+            GetFeatureBit(quirk.m_Feature) = VK_FALSE;
     }
-    bool IsLayerEnabled(const char* layerName) const
+
+    // Called for VKEFH_DEVICE_PROPERTY_STRUCT_REQUIRES while constructing the object.
+    void SetPropertyStructRequirement(DevicePropertyStructId structId, const char* extensionName, uint32_t apiVersion)
     {
-        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
-        return m_Layers.IsEnabled(layerName);
+        PropertyStruct& propertyStruct = m_PropertyStructs[(size_t)structId];
+        if(extensionName != nullptr)
+        {
+            const size_t extIndex = m_Extensions.Find(extensionName);
+            VKEFH_ASSERT(extIndex != SIZE_MAX &&
+                "Extensions used in VKEFH_DEVICE_PROPERTY_STRUCT_REQUIRES must be specified in VkExtensionsFeatures.inl.");
+            propertyStruct.m_ExtensionIndex = (uint32_t)extIndex;
+        }
+        propertyStruct.m_ApiVersion = apiVersion;
     }
-    bool EnableLayer(const char* layerName, bool enabled)
+
+    void* GetEnableStructPtr(DeviceFeatureStructId structId)
     {
-        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
-        return m_Layers.Enable(layerName, enabled);
+        if(structId == DeviceFeatureStructId::VkPhysicalDeviceFeatures)
+            return &m_EnableFeatures2.features;
+        VKEFH_ASSERT((size_t)structId < m_EnableStructPtrs.size() && "You can query only for feature structs specified in VkExtensionsFeatures.inl.");
+        return m_EnableStructPtrs[(size_t)structId];
     }
-    void EnableAllLayers(bool enabled)
+    const void* GetEnableStructPtr(DeviceFeatureStructId structId) const
     {
-        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
-        m_Layers.EnableAll(enabled);
+        if(structId == DeviceFeatureStructId::VkPhysicalDeviceFeatures)
+            return &m_EnableFeatures2.features;
+        VKEFH_ASSERT((size_t)structId < m_EnableStructPtrs.size() && "You can query only for feature structs specified in VkExtensionsFeatures.inl.");
+        return m_EnableStructPtrs[(size_t)structId];
     }
 
-    void PrepareCreation()
+    // In minimal enable mode, leaves structures with no requested members out of the chain.
+    void UpdateEmptyFeatureStructs()
     {
-        VKEFH_ASSERT(m_LayersEnumerated && "You should call EnumerateLayers first.");
-        
-        PrepareEnabledExtensionNames();
-        
-        m_Layers.PrepareEnabled();
-        
-        m_FeaturesChain = nullptr;
-        for(size_t structIndex = 0, structCount = m_FeatureStructs.size(); structIndex < structCount; ++structIndex)
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
         {
-            if(m_FeatureStructs[structIndex].m_Enabled)
+            bool empty = m_MinimalEnable;
+            if(empty)
             {
-                VKEFH_ASSERT(m_FeatureStructs[structIndex].m_StructPtr->sType == m_FeatureStructs[structIndex].m_sType);
-                m_FeatureStructs[structIndex].m_StructPtr->pNext = m_FeaturesChain;
-                m_FeaturesChain = m_FeatureStructs[structIndex].m_StructPtr;
+                const VkBool32* const bools = (const VkBool32*)(m_EnableStructPtrs[i] + 1);
+                for(uint32_t boolIndex = 0; boolIndex < m_FeatureStructs[i].m_BoolCount && empty; ++boolIndex)
+                    empty = bools[boolIndex] == VK_FALSE;
             }
+            if(empty != m_FeatureStructs[i].m_Empty)
+                SetFeatureStructEmpty(i, empty);
         }
+    }
 
-        m_CreationPrepared = true;
+    // Starts building the pNext chain from scratch, from supported or enabled copies of feature structures.
+    void SwitchFeatureChain(bool enableCopies)
+    {
+        for(size_t i = 0, count = m_FeatureStructs.size(); i < count; ++i)
+        {
+            m_FeatureStructs[i].m_LinkPtr = enableCopies ? m_EnableStructPtrs[i] : m_FeatureStructs[i].m_StructPtr;
+            m_FeatureStructs[i].m_Empty = false;
+        }
+        m_Features2.pNext = nullptr;
+        m_EnableFeatures2.pNext = nullptr;
+        m_ChainUsesEnableCopies = enableCopies;
+        ResetFeatureChain();
     }
 
-    uint32_t GetEnabledLayerCount() const
+    // Returns members of a feature structure after sType and pNext as an array of VkBool32.
+    // Trailing padding is not included, as the driver may write anything there.
+    VkBool32* GetFeatureBools(DeviceFeatureStructId structId, size_t& outCount)
     {
-        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
-        return (uint32_t)m_Layers.m_EnabledItemNames.size();
+        if(structId == DeviceFeatureStructId::VkPhysicalDeviceFeatures)
+        {
+            outCount = sizeof(VkPhysicalDeviceFeatures) / sizeof(VkBool32);
+            return (VkBool32*)&m_Features2.features;
+        }
+        const FeatureStruct& featureStruct = m_FeatureStructs[(size_t)structId];
+        outCount = featureStruct.m_BoolCount;
+        return (VkBool32*)(featureStruct.m_StructPtr + 1);
     }
-    const char* const* GetEnabledLayerNames() const
+    const VkBool32* GetFeatureBools(DeviceFeatureStructId structId, size_t& outCount) const
     {
-        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
-        return !m_Layers.m_EnabledItemNames.empty() ? m_Layers.m_EnabledItemNames.data() : nullptr;
+        return const_cast<DeviceInitHelp*>(this)->GetFeatureBools(structId, outCount);
     }
-    const void* GetFeaturesChain() const
+    // Like GetFeatureBools, for the copy of the structure with members requested using RequestFeature.
+    VkBool32* GetEnableFeatureBools(DeviceFeatureStructId structId)
     {
-        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
-        return m_FeaturesChain;
+        return structId == DeviceFeatureStructId::VkPhysicalDeviceFeatures ?
+            (VkBool32*)&m_EnableFeatures2.features :
+            (VkBool32*)(m_EnableStructPtrs[(size_t)structId] + 1);
     }
 
-private:
-    bool m_LayersEnumerated = false;
-    EnabledItemVector m_Layers;
-    VkBaseInStructure* m_FeaturesChain = nullptr;
-
-    void LoadLayers(const VkLayerProperties* layerProps, size_t layerPropCount)
+    // Reads the root object: {"capabilities": {"name": {"extensions": {...}, "features": {...}}}}.
+    bool ReadJsonCapabilityFile(JsonReader& reader)
     {
-        for(size_t layerPropIndex = 0; layerPropIndex < layerPropCount; ++layerPropIndex)
+        const char* key;
+        size_t keyLength;
+        if(!reader.BeginObject())
+            return false;
+        while(reader.NextKey(key, keyLength))
+        {
+            if(!JsonReader::KeyEquals(key, keyLength, "capabilities") || !reader.IsObjectNext())
+            {
+                if(!reader.SkipValue())
+                    return false;
+                continue;
+            }
+            reader.BeginObject();
+            while(reader.NextKey(key, keyLength))
+            {
+                if(!reader.BeginObject())
+                    return false;
+                while(reader.NextKey(key, keyLength))
+                {
+                    bool success;
+                    if(JsonReader::KeyEquals(key, keyLength, "extensions"))
+                        success = ReadJsonExtensions(reader);
+                    else if(JsonReader::KeyEquals(key, keyLength, "features"))
+                        success = ReadJsonFeatures(reader);
+                    else
+                        success = reader.SkipValue();
+                    if(!success)
+                        return false;
+                }
+                if(reader.HasFailed())
+                    return false;
+            }
+            if(reader.HasFailed())
+                return false;
+        }
+        return !reader.HasFailed();
+    }
+    // Reads {"VK_KHR_swapchain": 70, ...}.
+    bool ReadJsonExtensions(JsonReader& reader)
+    {
+        const char* key;
+        size_t keyLength;
+        if(!reader.BeginObject())
+            return false;
+        while(reader.NextKey(key, keyLength))
+        {
+            char name[VK_MAX_EXTENSION_NAME_SIZE];
+            if(keyLength < VK_MAX_EXTENSION_NAME_SIZE)
+            {
+                memcpy(name, key, keyLength);
+                name[keyLength] = '\0';
+                const size_t extIndex = m_Extensions.Find(name);
+                if(extIndex != SIZE_MAX)
+                    m_Extensions.m_Items[extIndex].m_Supported = true;
+            }
+            if(!reader.SkipValue())
+                return false;
+        }
+        return !reader.HasFailed();
+    }
+    // Reads {"VkPhysicalDeviceFeatures": {"robustBufferAccess": true, ...}, ...}.
+    bool ReadJsonFeatures(JsonReader& reader)
+    {
+        const char* key;
+        size_t keyLength;
+        if(!reader.BeginObject())
+            return false;
+        while(reader.NextKey(key, keyLength))
         {
-            for(size_t layerIndex = 0, layerCount = m_Layers.m_Items.size(); layerIndex < layerCount; ++layerIndex)
+            const FeatureMemberName* structMembers = nullptr;
+            for(const FeatureMemberName* m = DefinitionFeatureMembers<>::s_Members; m->m_StructName != nullptr; ++m)
+            {
+                if(JsonReader::KeyEquals(key, keyLength, m->m_StructName))
+                {
+                    structMembers = m;
+                    break;
+                }
+            }
+            if(structMembers == nullptr)
+            {
+                if(!reader.SkipValue())
+                    return false;
+                continue;
+            }
+            if(!reader.BeginObject())
+                return false;
+            while(reader.NextKey(key, keyLength))
             {
-                if(strcmp(layerProps[layerPropIndex].layerName, m_Layers.m_Items[layerIndex].m_Name) == 0)
+                const FeatureMemberName* member = structMembers;
+                for(; member->m_StructName != nullptr; ++member)
+                {
+                    if(member->m_Bit.m_Struct == structMembers->m_Bit.m_Struct &&
+                        JsonReader::KeyEquals(key, keyLength, member->m_MemberName))
+                    {
+                        break;
+                    }
+                }
+                bool value;
+                if(member->m_StructName == nullptr)
+                {
+                    if(!reader.SkipValue())
+                        return false;
+                }
+                else if(reader.ReadBool(value))
                 {
-                    m_Layers.m_Items[layerIndex].m_Supported = true;
-                    m_Layers.m_Items[layerIndex].m_Enabled = true;
+                    *(VkBool32*)((char*)GetFeatureStructPtr(member->m_Bit.m_Struct) + member->m_Bit.m_Offset) =
+                        value ? VK_TRUE : VK_FALSE;
                 }
+                else
+                    return false;
             }
+            if(reader.HasFailed())
+                return false;
         }
+        return !reader.HasFailed();
     }
 };
 
-class DeviceInitHelp : public InitHelpBase
+#if VKEFH_USE_MAPPED_FILES
+
+/*
+Loads pipeline cache data saved for a specific device, driver, and set of enabled extensions and features
+on a background thread, so it can overlap with vkCreateDevice. The data is mapped from the file and passed
+to vkCreatePipelineCache without copying.
+*/
+class PipelineCacheLoader
 {
-	DeviceInitHelp(const DeviceInitHelp&) = delete;
-	DeviceInitHelp(DeviceInitHelp&&) = delete;
-	DeviceInitHelp& operator=(const DeviceInitHelp&) = delete;
-	DeviceInitHelp& operator=(DeviceInitHelp&&) = delete;
+public:
+    PipelineCacheLoader() { }
+    ~PipelineCacheLoader() { Close(); }
+    PipelineCacheLoader(const PipelineCacheLoader&) = delete;
+    PipelineCacheLoader& operator=(const PipelineCacheLoader&) = delete;
 
-#define VKEFH_INSTANCE_EXTENSION(extensionName)
-#define VKEFH_INSTANCE_LAYER(layerName)
-#define VKEFH_INSTANCE_FEATURE_STRUCT(structName, sType)
-#define VKEFH_DEVICE_EXTENSION(extensionName)
-#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType) \
-    private: structName m_##structName = { (sType) }; \
-    public: structName& Get##structName() \
-    { \
-        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first."); \
-        return m_##structName; \
-    } \
-    public: const structName& Get##structName() const \
-    { \
-        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first."); \
-        return m_##structName; \
+    /*
+    Starts opening and validating the file on a background thread. Call it after DeviceInitHelp::GetPhysicalDeviceIdentity
+    and PrepareCreation, e.g. right before vkCreateDevice.
+    */
+    void StartLoading(const char* filePath, const DeviceInitHelp& initHelp)
+    {
+        Close();
+        m_Key = MakeHeader(initHelp);
+        m_Identity = initHelp.GetIdentity();
+        m_FilePath = filePath;
+        m_Thread = std::thread([this]() { m_Loaded = Load(); });
     }
 
-#include "VkExtensionsFeatures.inl"
+    /*
+    Waits for loading to finish. If the file was saved for the same device, driver, and enabled extensions and features,
+    sets initialDataSize and pInitialData of createInfo to data mapped from the file, valid until Close, and returns true.
+    Otherwise sets them to zero, so an empty cache is created, and returns false.
+    */
+    bool GetCreateInfo(VkPipelineCacheCreateInfo& createInfo)
+    {
+        Wait();
+        createInfo.initialDataSize = m_Loaded ? m_File.GetSize() - sizeof(Header) : 0;
+        createInfo.pInitialData = m_Loaded ? (const char*)m_File.GetData() + sizeof(Header) : nullptr;
+        return m_Loaded;
+    }
 
-#undef VKEFH_INSTANCE_EXTENSION
-#undef VKEFH_INSTANCE_LAYER
-#undef VKEFH_INSTANCE_FEATURE_STRUCT
-#undef VKEFH_DEVICE_EXTENSION
-#undef VKEFH_DEVICE_FEATURE_STRUCT
+    // Waits for loading to finish and unmaps the file. Call it after vkCreatePipelineCache, before saving to the same file.
+    void Close()
+    {
+        Wait();
+        m_File.Close();
+        m_Loaded = false;
+    }
 
-public:
-    DeviceInitHelp()
+    /*
+    Saves data returned by vkGetPipelineCacheData to a file, together with GetCapabilityFingerprint
+    of the device, to be loaded later using StartLoading.
+    */
+    static bool Save(const char* filePath, const DeviceInitHelp& initHelp, const void* data, size_t dataSize)
+    {
+        Header header = MakeHeader(initHelp);
+        header.m_DataSize = dataSize;
+        return WriteFileAtomically(filePath, &header, sizeof(header), data, dataSize);
+    }
+
+private:
+    struct Header
     {
-#define VKEFH_INSTANCE_EXTENSION(extensionName)
-#define VKEFH_INSTANCE_LAYER(layerName)
-#define VKEFH_INSTANCE_FEATURE_STRUCT(structName, sType)
-#define VKEFH_DEVICE_EXTENSION(extensionName)   m_Extensions.m_Items.push_back({(extensionName), false, false});
-#define VKEFH_DEVICE_FEATURE_STRUCT(structName, sType)   m_FeatureStructs.push_back({(#structName), (sType), (VkBaseInStructure*)(&m_##structName), true});
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        uint64_t m_CapabilityFingerprint;
+        uint64_t m_DataSize;
+    };
+    static const uint32_t PIPELINE_CACHE_MAGIC = 0x4350454B; // "KEPC"
+    static const uint32_t PIPELINE_CACHE_VERSION = 1;
+    // Size of VkPipelineCacheHeaderVersionOne.
+    static const size_t VULKAN_HEADER_SIZE = 16 + VK_UUID_SIZE;
 
-#include "VkExtensionsFeatures.inl"
+    MappedFile m_File;
+    std::string m_FilePath;
+    std::thread m_Thread;
+    Header m_Key = {};
+    DeviceIdentity m_Identity = {};
+    bool m_Loaded = false;
 
-#undef VKEFH_INSTANCE_EXTENSION
-#undef VKEFH_INSTANCE_LAYER
-#undef VKEFH_INSTANCE_FEATURE_STRUCT
-#undef VKEFH_DEVICE_EXTENSION
-#undef VKEFH_DEVICE_FEATURE_STRUCT
+    static Header MakeHeader(const DeviceInitHelp& initHelp)
+    {
+        Header header = {};
+        header.m_Magic = PIPELINE_CACHE_MAGIC;
+        header.m_Version = PIPELINE_CACHE_VERSION;
+        header.m_CapabilityFingerprint = initHelp.GetCapabilityFingerprint();
+        return header;
     }
 
-	void Reset()
-	{
-		InitHelpBase::Reset();
-		m_PhysicalDeviceFeaturesQueried = false;
-		m_Features2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
-	}
+    void Wait()
+    {
+        if(m_Thread.joinable())
+            m_Thread.join();
+    }
 
-    VkResult EnumerateExtensions(VkPhysicalDevice physicalDevice)
+    // Called on the background thread.
+    bool Load()
     {
-        VKEFH_ASSERT(physicalDevice);
-        uint32_t extPropCount = 0;
-        VkResult res = vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extPropCount, nullptr);
-        if(res != VK_SUCCESS)
+        if(!m_File.Open(m_FilePath.c_str()))
+            return false;
+        if(m_File.GetSize() < sizeof(Header) + VULKAN_HEADER_SIZE)
         {
-            return res;
+            m_File.Close();
+            return false;
         }
-        std::vector<VkExtensionProperties> extProps{extPropCount};
-        if(extPropCount)
+        const uint8_t* const data = (const uint8_t*)m_File.GetData() + sizeof(Header);
+        const size_t dataSize = m_File.GetSize() - sizeof(Header);
+        Header header;
+        memcpy(&header, m_File.GetData(), sizeof(header));
+        bool valid = header.m_Magic == m_Key.m_Magic &&
+            header.m_Version == m_Key.m_Version &&
+            header.m_CapabilityFingerprint == m_Key.m_CapabilityFingerprint &&
+            header.m_DataSize == dataSize;
+        if(valid)
         {
-            res = vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extPropCount, extProps.data());
-            if(res != VK_SUCCESS)
-            {
-                return res;
-            }
-            LoadExtensions(extProps.data(), extPropCount);
+            // Check VkPipelineCacheHeaderVersionOne written by the driver at the beginning of the data.
+            uint32_t vulkanHeader[4];
+            memcpy(vulkanHeader, data, sizeof(vulkanHeader));
+            valid = vulkanHeader[0] >= VULKAN_HEADER_SIZE &&
+                vulkanHeader[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                vulkanHeader[2] == m_Identity.m_VendorID &&
+                vulkanHeader[3] == m_Identity.m_DeviceID &&
+                memcmp(data + 16, m_Identity.m_PipelineCacheUUID, VK_UUID_SIZE) == 0;
         }
-        return VK_SUCCESS;
+        if(!valid)
+        {
+            m_File.Close();
+            return false;
+        }
+        // Touch every page, so the data is read from disk now rather than inside vkCreatePipelineCache.
+        for(size_t offset = 0; offset < dataSize; offset += 4096)
+            (void)*(const volatile uint8_t*)(data + offset);
+        return true;
     }
+};
 
-    void GetPhysicalDeviceFeatures(VkPhysicalDevice physicalDevice)
-    {
-        VKEFH_ASSERT(physicalDevice);
-        VKEFH_ASSERT(!m_PhysicalDeviceFeaturesQueried && "You should call GetPhysicalDeviceFeatures only once.");
-
-        VKEFH_ASSERT(m_Features2.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2);
-        m_Features2.pNext = nullptr;
+#endif // #if VKEFH_USE_MAPPED_FILES
 
-        for(size_t structIndex = 0, structCount = m_FeatureStructs.size(); structIndex < structCount; ++structIndex)
-        {
-            if(m_FeatureStructs[structIndex].m_Enabled)
-            {
-                VKEFH_ASSERT(m_FeatureStructs[structIndex].m_StructPtr->sType == m_FeatureStructs[structIndex].m_sType);
-                m_FeatureStructs[structIndex].m_StructPtr->pNext = (VkBaseInStructure*)m_Features2.pNext;
-                m_Features2.pNext = m_FeatureStructs[structIndex].m_StructPtr;
-            }
-        }
+/*
+Probes multiple physical devices in parallel using DeviceInitHelp and ranks them
+by a score computed from extensions and feature bits with user-specified weights.
+*/
+class PhysicalDeviceSelector
+{
+public:
+    struct RankedDevice
+    {
+        VkPhysicalDevice m_PhysicalDevice;
+        float m_Score;
+        // Object after EnumerateExtensions and GetPhysicalDeviceFeatures, ready for PrepareCreation.
+        std::unique_ptr<DeviceInitHelp> m_InitHelp;
+    };
 
-        vkGetPhysicalDeviceFeatures2(physicalDevice, &m_Features2);
+    // Sets pointers to Vulkan functions to be used by all DeviceInitHelp objects created by this object.
+    void SetVulkanFunctions(const VulkanFunctions& functions) { m_VulkanFunctions = functions; }
 
-        m_PhysicalDeviceFeaturesQueried = true;
+    // Devices that don't support a required extension are rejected. Otherwise, weight is added to the score if supported.
+    void AddExtension(DeviceExtensionId extension, bool required, float weight = 1.f)
+    {
+        VKEFH_ASSERT((uint32_t)extension < DEVICE_EXTENSION_COUNT && "You can use only extensions specified in VkExtensionsFeatures.inl.");
+        m_Criteria.push_back({false, extension, {}, required, weight});
     }
-
-    VkPhysicalDeviceFeatures& GetFeatures()
+    void AddExtension(const char* extensionName, bool required, float weight = 1.f)
     {
-        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
-        return m_Features2.features;
+        AddExtension(GetDeviceExtensionId(extensionName), required, weight);
+    }
+    // Devices that don't support a required feature are rejected. Otherwise, weight is added to the score if supported.
+    void AddFeature(DeviceFeatureBit feature, bool required, float weight = 1.f)
+    {
+        m_Criteria.push_back({true, DeviceExtensionId(), feature, required, weight});
     }
-	const VkPhysicalDeviceFeatures& GetFeatures() const
-	{
-        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
-		return m_Features2.features;
-	}
 
-    void PrepareCreation()
+    /*
+    Calls EnumerateExtensions and GetPhysicalDeviceFeatures for all given physical devices,
+    using up to maxThreadCount threads (0 means number of hardware threads) if VKEFH_USE_THREADS is 1.
+    Each thread probes whole devices, so no more threads are used than there are devices.
+    Fills outRankedDevices with devices that meet all required criteria, sorted from the highest score.
+    Devices for which the query failed are skipped and the first error is returned.
+    */
+    VkResult Select(const VkPhysicalDevice* physicalDevices, uint32_t physicalDeviceCount,
+        std::vector<RankedDevice>& outRankedDevices, uint32_t maxThreadCount = 0) const
     {
-        VKEFH_ASSERT(m_ExtensionsEnumerated && "You need to call EnumerateExtensions first.");
-        VKEFH_ASSERT(m_PhysicalDeviceFeaturesQueried && "You need to call GetPhysicalDeviceFeatures first.");
+        outRankedDevices.clear();
+        if(physicalDeviceCount == 0)
+            return VK_SUCCESS;
 
-        PrepareEnabledExtensionNames();
+        std::vector<std::unique_ptr<DeviceInitHelp>> initHelps(physicalDeviceCount);
+        std::vector<VkResult> results(physicalDeviceCount, VK_SUCCESS);
+#if VKEFH_USE_THREADS
+        std::atomic<uint32_t> nextDeviceIndex(0);
+#else
+        uint32_t nextDeviceIndex = 0;
+#endif
+        auto worker = [&]()
+        {
+            for(uint32_t i = nextDeviceIndex++; i < physicalDeviceCount; i = nextDeviceIndex++)
+            {
+                initHelps[i].reset(new DeviceInitHelp());
+                initHelps[i]->SetVulkanFunctions(m_VulkanFunctions);
+                results[i] = initHelps[i]->EnumerateExtensions(physicalDevices[i]);
+                if(results[i] == VK_SUCCESS)
+                    initHelps[i]->GetPhysicalDeviceFeatures(physicalDevices[i]);
+            }
+        };
 
-        VKEFH_ASSERT(m_Features2.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2);
-        m_Features2.pNext = nullptr;
-        for(size_t structIndex = 0, structCount = m_FeatureStructs.size(); structIndex < structCount; ++structIndex)
+#if VKEFH_USE_THREADS
+        if(maxThreadCount == 0)
+            maxThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        const uint32_t threadCount = std::min(maxThreadCount, physicalDeviceCount);
+        // The calling thread is one of the workers.
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for(uint32_t i = 1; i < threadCount; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for(size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+#else
+        (void)maxThreadCount;
+        worker();
+#endif
+
+        VkResult firstError = VK_SUCCESS;
+        for(uint32_t i = 0; i < physicalDeviceCount; ++i)
         {
-            if(m_FeatureStructs[structIndex].m_Enabled)
+            if(results[i] != VK_SUCCESS)
             {
-                VKEFH_ASSERT(m_FeatureStructs[structIndex].m_StructPtr->sType == m_FeatureStructs[structIndex].m_sType);
-                m_FeatureStructs[structIndex].m_StructPtr->pNext = (VkBaseInStructure*)m_Features2.pNext;
-                m_Features2.pNext = m_FeatureStructs[structIndex].m_StructPtr;
+                if(firstError == VK_SUCCESS)
+                    firstError = results[i];
+                continue;
             }
+            float score = 0.f;
+            if(CalculateScore(*initHelps[i], score))
+                outRankedDevices.push_back({physicalDevices[i], score, std::move(initHelps[i])});
         }
-        
-        m_CreationPrepared = true;
+        std::stable_sort(outRankedDevices.begin(), outRankedDevices.end(),
+            [](const RankedDevice& lhs, const RankedDevice& rhs) { return lhs.m_Score > rhs.m_Score; });
+        return firstError;
     }
 
-    const void* GetFeaturesChain() const
+private:
+    struct Criterion
     {
-        VKEFH_ASSERT(m_CreationPrepared && "You need to call PrepareCreation first.");
-        return &m_Features2;
-    }
+        bool m_IsFeature;
+        DeviceExtensionId m_Extension;
+        DeviceFeatureBit m_Feature;
+        bool m_Required;
+        float m_Weight;
+    };
+    std::vector<Criterion> m_Criteria;
+    VulkanFunctions m_VulkanFunctions = {};
 
-private:
-    bool m_PhysicalDeviceFeaturesQueried = false;
-    VkPhysicalDeviceFeatures2 m_Features2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+    // Returns false if the device doesn't meet some required criterion.
+    bool CalculateScore(const DeviceInitHelp& initHelp, float& outScore) const
+    {
+        outScore = 0.f;
+        for(size_t i = 0, count = m_Criteria.size(); i < count; ++i)
+        {
+            const Criterion& criterion = m_Criteria[i];
+            const bool supported = criterion.m_IsFeature ?
+                initHelp.GetFeatureBit(criterion.m_Feature) != VK_FALSE :
+                initHelp.IsExtensionSupported(criterion.m_Extension);
+            if(supported)
+                outScore += criterion.m_Weight;
+            else if(criterion.m_Required)
+                return false;
+        }
+        return true;
+    }
 };
 
-} // namespace VKEFH
+} // namespace VKEFH_NAMESPACE
+
+#endif // #if VKEFH_DEFINE_SET
+
+#undef VKEFH_DEFINE_SET
+#undef VKEFH_CUSTOM_NAMESPACE
+#undef VKEFH_NAMESPACE
+#undef VKEFH_DEFINITION_FILE
+
+#endif // #ifdef VKEFH_EXPAND_DEFINITION_FILE
@@ -0,0 +1,219 @@
+/*
+Benchmark of VkExtensionsFeaturesHelp that runs without a GPU or Vulkan loader.
+
+The library calls Vulkan functions defined in StubVulkan.cpp, which report a configurable number
+of synthetic extensions and layers with the ones declared in the definition set mixed in.
+Each benchmark executable is built with a different definition set generated by CMakeLists.txt.
+For each number of reported extensions, it prints one row with times of construction,
+EnumerateExtensions, EnumerateLayers, PrepareCreation, and queries of instance and device helpers
+and DeviceCapabilities.
+
+Usage: VkExtensionsFeaturesHelpBench<declaredCount> [extensionCount...]
+Default counts are 50, 200, 1000, 5000, 10000. A tenth of that number of layers is reported.
+*/
+
+#include "StubVulkan.hpp"
+#include "VkExtensionsFeaturesHelp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+const uint32_t DEFAULT_EXTENSION_COUNTS[] = { 50, 200, 1000, 5000, 10000 };
+const uint32_t SAMPLE_COUNT = 5;
+const uint32_t QUERY_ITERATION_COUNT = 100000;
+const VkPhysicalDevice PHYSICAL_DEVICE = (VkPhysicalDevice)(uintptr_t)1;
+
+volatile uint32_t g_Sink;
+
+void SetStubItems(uint32_t extensionCount, uint32_t layerCount)
+{
+    // Both instance and device extensions are reported by both, like a loader with many layers would do.
+    std::vector<const char*> declaredNames;
+    declaredNames.insert(declaredNames.end(), VKEFH::DefinitionNames<>::s_InstanceExtensions,
+        VKEFH::DefinitionNames<>::s_InstanceExtensions + VKEFH::INSTANCE_EXTENSION_COUNT);
+    declaredNames.insert(declaredNames.end(), VKEFH::DefinitionNames<>::s_DeviceExtensions,
+        VKEFH::DefinitionNames<>::s_DeviceExtensions + VKEFH::DEVICE_EXTENSION_COUNT);
+    StubVulkan::SetExtensions(extensionCount, declaredNames.data(), (uint32_t)declaredNames.size());
+    StubVulkan::SetLayers(layerCount, VKEFH::DefinitionNames<>::s_InstanceLayers, VKEFH::INSTANCE_LAYER_COUNT);
+}
+
+double GetMedian(double (&samples)[SAMPLE_COUNT])
+{
+    std::sort(samples, samples + SAMPLE_COUNT);
+    return samples[SAMPLE_COUNT / 2];
+}
+
+double GetNanoseconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+{
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+}
+
+// Returns median time of constructing one object, in nanoseconds.
+template<typename T>
+double MeasureConstruction(uint32_t batchSize)
+{
+    double samples[SAMPLE_COUNT];
+    for(uint32_t sampleIndex = 0; sampleIndex < SAMPLE_COUNT; ++sampleIndex)
+    {
+        std::vector<std::unique_ptr<T>> objects(batchSize);
+        const auto begin = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < batchSize; ++i)
+            objects[i].reset(new T());
+        samples[sampleIndex] = GetNanoseconds(begin, std::chrono::steady_clock::now()) / batchSize;
+    }
+    return GetMedian(samples);
+}
+
+/*
+Creates batchSize objects and calls setup on each of them, then measures only calls to op.
+Each call gets a fresh object, as most operations can be done only once per object.
+Returns median time of one call, in nanoseconds.
+*/
+template<typename T, typename Setup, typename Op>
+double MeasureOperation(uint32_t batchSize, Setup setup, Op op)
+{
+    double samples[SAMPLE_COUNT];
+    for(uint32_t sampleIndex = 0; sampleIndex < SAMPLE_COUNT; ++sampleIndex)
+    {
+        std::vector<std::unique_ptr<T>> objects(batchSize);
+        for(uint32_t i = 0; i < batchSize; ++i)
+        {
+            objects[i].reset(new T());
+            setup(*objects[i]);
+        }
+        const auto begin = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < batchSize; ++i)
+            op(*objects[i]);
+        samples[sampleIndex] = GetNanoseconds(begin, std::chrono::steady_clock::now()) / batchSize;
+    }
+    return GetMedian(samples);
+}
+
+// Returns median time of one query, in nanoseconds. query is called with indices from 0 to itemCount - 1.
+template<typename Query>
+double MeasureQuery(uint32_t itemCount, Query query)
+{
+    double samples[SAMPLE_COUNT];
+    for(uint32_t sampleIndex = 0; sampleIndex < SAMPLE_COUNT; ++sampleIndex)
+    {
+        uint32_t sum = 0;
+        const auto begin = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < QUERY_ITERATION_COUNT; ++i)
+            sum += query(i % itemCount) ? 1 : 0;
+        samples[sampleIndex] = GetNanoseconds(begin, std::chrono::steady_clock::now()) / QUERY_ITERATION_COUNT;
+        g_Sink = sum;
+    }
+    return GetMedian(samples);
+}
+
+void EnumerateInstance(VKEFH::InstanceInitHelp& initHelp)
+{
+    if(initHelp.EnumerateExtensions() != VK_SUCCESS || initHelp.EnumerateLayers() != VK_SUCCESS)
+        abort();
+}
+
+void EnumerateDevice(VKEFH::DeviceInitHelp& initHelp)
+{
+    // The stub device reports Vulkan 1.2, so core structures and promoted extensions are used.
+    initHelp.SetTargetApiVersion(VK_API_VERSION_1_2);
+    if(initHelp.EnumerateExtensions(PHYSICAL_DEVICE) != VK_SUCCESS)
+        abort();
+    initHelp.GetPhysicalDeviceFeatures(PHYSICAL_DEVICE);
+}
+
+void RunForExtensionCount(uint32_t extensionCount)
+{
+    const uint32_t layerCount = extensionCount / 10;
+    SetStubItems(extensionCount, layerCount);
+    // Enough objects per sample to measure reliably, without taking long for large counts.
+    const uint32_t batchSize = std::max(8u, std::min(1000u, 100000u / extensionCount));
+
+    const double instanceConstruction = MeasureConstruction<VKEFH::InstanceInitHelp>(batchSize);
+    const double deviceConstruction = MeasureConstruction<VKEFH::DeviceInitHelp>(batchSize);
+    const double instanceEnumeration = MeasureOperation<VKEFH::InstanceInitHelp>(batchSize,
+        [](VKEFH::InstanceInitHelp&) {},
+        [](VKEFH::InstanceInitHelp& initHelp) { g_Sink = (uint32_t)initHelp.EnumerateExtensions(); });
+    const double layerEnumeration = MeasureOperation<VKEFH::InstanceInitHelp>(batchSize,
+        [](VKEFH::InstanceInitHelp&) {},
+        [](VKEFH::InstanceInitHelp& initHelp) { g_Sink = (uint32_t)initHelp.EnumerateLayers(); });
+    const double deviceEnumeration = MeasureOperation<VKEFH::DeviceInitHelp>(batchSize,
+        [](VKEFH::DeviceInitHelp&) {},
+        [](VKEFH::DeviceInitHelp& initHelp) { g_Sink = (uint32_t)initHelp.EnumerateExtensions(PHYSICAL_DEVICE); });
+    const double instancePreparation = MeasureOperation<VKEFH::InstanceInitHelp>(batchSize,
+        &EnumerateInstance,
+        [](VKEFH::InstanceInitHelp& initHelp) { initHelp.PrepareCreation(); });
+    const double devicePreparation = MeasureOperation<VKEFH::DeviceInitHelp>(batchSize,
+        &EnumerateDevice,
+        [](VKEFH::DeviceInitHelp& initHelp) { initHelp.PrepareCreation(); });
+
+    VKEFH::InstanceInitHelp instanceInitHelp;
+    EnumerateInstance(instanceInitHelp);
+    VKEFH::DeviceInitHelp deviceInitHelp;
+    EnumerateDevice(deviceInitHelp);
+    deviceInitHelp.PrepareCreation();
+    const VKEFH::DeviceCapabilities caps = deviceInitHelp.GetCapabilities();
+    const double queryByName = MeasureQuery(VKEFH::DEVICE_EXTENSION_COUNT, [&deviceInitHelp](uint32_t i)
+    {
+        return deviceInitHelp.IsExtensionEnabled(VKEFH::DefinitionNames<>::s_DeviceExtensions[i]);
+    });
+    const double queryById = MeasureQuery(VKEFH::DEVICE_EXTENSION_COUNT, [&deviceInitHelp](uint32_t i)
+    {
+        return deviceInitHelp.IsExtensionEnabled((VKEFH::DeviceExtensionId)i);
+    });
+    const double capsQuery = MeasureQuery(VKEFH::DEVICE_EXTENSION_COUNT, [&caps](uint32_t i)
+    {
+        return caps.IsExtensionEnabled((VKEFH::DeviceExtensionId)i);
+    });
+    const double layerQueryByName = MeasureQuery(VKEFH::INSTANCE_LAYER_COUNT, [&instanceInitHelp](uint32_t i)
+    {
+        return instanceInitHelp.IsLayerSupported(VKEFH::DefinitionNames<>::s_InstanceLayers[i]);
+    });
+
+    printf("%10u %10u %10u %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f %10.1f %10.1f %10.1f %10.1f\n",
+        VKEFH::DEVICE_EXTENSION_COUNT, extensionCount, layerCount,
+        instanceConstruction, deviceConstruction,
+        instanceEnumeration, layerEnumeration, deviceEnumeration,
+        instancePreparation, devicePreparation,
+        queryByName, queryById, capsQuery, layerQueryByName);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<uint32_t> extensionCounts;
+    for(int i = 1; i < argc; ++i)
+    {
+        const long count = strtol(argv[i], nullptr, 10);
+        if(count <= 0)
+        {
+            fprintf(stderr, "Invalid extension count: %s\n", argv[i]);
+            return 1;
+        }
+        extensionCounts.push_back((uint32_t)count);
+    }
+    if(extensionCounts.empty())
+    {
+        extensionCounts.assign(DEFAULT_EXTENSION_COUNTS,
+            DEFAULT_EXTENSION_COUNTS + sizeof(DEFAULT_EXTENSION_COUNTS) / sizeof(DEFAULT_EXTENSION_COUNTS[0]));
+    }
+
+    printf("Declared: %u instance extensions, %u instance layers, %u device extensions, %u device feature structures.\n",
+        VKEFH::INSTANCE_EXTENSION_COUNT, VKEFH::INSTANCE_LAYER_COUNT,
+        VKEFH::DEVICE_EXTENSION_COUNT, VKEFH::DEVICE_FEATURE_STRUCT_COUNT);
+    printf("Times in nanoseconds, median of %u samples.\n", SAMPLE_COUNT);
+    printf("%10s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+        "DevDecl", "Reported", "Layers", "InstCtor", "DevCtor", "InstEnum", "LayerEnum", "DevEnum",
+        "InstPrep", "DevPrep", "ByName", "ById", "CapsById", "LayerName");
+    for(size_t i = 0; i < extensionCounts.size(); ++i)
+        RunForExtensionCount(extensionCounts[i]);
+    return 0;
+}
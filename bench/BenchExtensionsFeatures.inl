@@ -0,0 +1,72 @@
+// Base of the definition sets used by the benchmark: a typical mix of instance and device
+// extensions, dependencies between them, and feature structures. CMakeLists.txt generates each
+// set as VkExtensionsFeatures.inl that includes this file and declares a number of synthetic
+// extensions and layers on top of it. Extensions not named in the minimal Vulkan headers are
+// given as string literals.
+
+VKEFH_INSTANCE_EXTENSION(VK_KHR_SURFACE_EXTENSION_NAME)
+VKEFH_INSTANCE_EXTENSION(VK_EXT_DEBUG_UTILS_EXTENSION_NAME)
+VKEFH_INSTANCE_EXTENSION("VK_KHR_win32_surface")
+VKEFH_INSTANCE_EXTENSION("VK_KHR_xlib_surface")
+VKEFH_INSTANCE_EXTENSION("VK_KHR_get_surface_capabilities2")
+VKEFH_INSTANCE_EXTENSION("VK_EXT_swapchain_colorspace")
+VKEFH_INSTANCE_EXTENSION_REQUIRES(VK_EXT_DEBUG_UTILS_EXTENSION_NAME, VK_KHR_SURFACE_EXTENSION_NAME)
+VKEFH_INSTANCE_EXTENSION_REQUIRES("VK_KHR_win32_surface", VK_KHR_SURFACE_EXTENSION_NAME)
+VKEFH_INSTANCE_EXTENSION_REQUIRES("VK_KHR_xlib_surface", VK_KHR_SURFACE_EXTENSION_NAME)
+
+VKEFH_INSTANCE_LAYER("VK_LAYER_KHRONOS_validation")
+
+VKEFH_DEVICE_EXTENSION(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION(VK_KHR_MAINTENANCE1_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION(VK_KHR_8BIT_STORAGE_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION(VK_KHR_STORAGE_BUFFER_STORAGE_CLASS_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION("VK_KHR_maintenance2")
+VKEFH_DEVICE_EXTENSION("VK_KHR_maintenance3")
+VKEFH_DEVICE_EXTENSION("VK_KHR_dedicated_allocation")
+VKEFH_DEVICE_EXTENSION("VK_KHR_get_memory_requirements2")
+VKEFH_DEVICE_EXTENSION("VK_KHR_bind_memory2")
+VKEFH_DEVICE_EXTENSION("VK_KHR_buffer_device_address")
+VKEFH_DEVICE_EXTENSION("VK_KHR_timeline_semaphore")
+VKEFH_DEVICE_EXTENSION("VK_KHR_synchronization2")
+VKEFH_DEVICE_EXTENSION("VK_KHR_dynamic_rendering")
+VKEFH_DEVICE_EXTENSION("VK_KHR_acceleration_structure")
+VKEFH_DEVICE_EXTENSION("VK_KHR_ray_tracing_pipeline")
+VKEFH_DEVICE_EXTENSION("VK_KHR_deferred_host_operations")
+VKEFH_DEVICE_EXTENSION("VK_EXT_descriptor_indexing")
+VKEFH_DEVICE_EXTENSION("VK_EXT_mesh_shader")
+VKEFH_DEVICE_EXTENSION("VK_KHR_spirv_1_4")
+VKEFH_DEVICE_EXTENSION("VK_KHR_shader_float_controls")
+VKEFH_DEVICE_EXTENSION("VK_AMD_device_coherent_memory")
+VKEFH_DEVICE_EXTENSION_REQUIRES(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME, VK_KHR_8BIT_STORAGE_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION_REQUIRES(VK_KHR_8BIT_STORAGE_EXTENSION_NAME, VK_KHR_STORAGE_BUFFER_STORAGE_CLASS_EXTENSION_NAME)
+VKEFH_DEVICE_EXTENSION_REQUIRES("VK_KHR_dedicated_allocation", "VK_KHR_get_memory_requirements2")
+VKEFH_DEVICE_EXTENSION_REQUIRES("VK_KHR_acceleration_structure", "VK_KHR_buffer_device_address")
+VKEFH_DEVICE_EXTENSION_REQUIRES("VK_KHR_acceleration_structure", "VK_KHR_deferred_host_operations")
+VKEFH_DEVICE_EXTENSION_REQUIRES("VK_KHR_acceleration_structure", "VK_EXT_descriptor_indexing")
+VKEFH_DEVICE_EXTENSION_REQUIRES("VK_KHR_ray_tracing_pipeline", "VK_KHR_acceleration_structure")
+VKEFH_DEVICE_EXTENSION_REQUIRES("VK_KHR_ray_tracing_pipeline", "VK_KHR_spirv_1_4")
+VKEFH_DEVICE_EXTENSION_REQUIRES("VK_KHR_spirv_1_4", "VK_KHR_shader_float_controls")
+VKEFH_DEVICE_EXTENSION_PROMOTED(VK_KHR_MAINTENANCE1_EXTENSION_NAME, VK_API_VERSION_1_1)
+VKEFH_DEVICE_EXTENSION_PROMOTED(VK_KHR_STORAGE_BUFFER_STORAGE_CLASS_EXTENSION_NAME, VK_API_VERSION_1_1)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_maintenance2", VK_API_VERSION_1_1)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_maintenance3", VK_API_VERSION_1_1)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_dedicated_allocation", VK_API_VERSION_1_1)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_get_memory_requirements2", VK_API_VERSION_1_1)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_bind_memory2", VK_API_VERSION_1_1)
+VKEFH_DEVICE_EXTENSION_PROMOTED(VK_KHR_8BIT_STORAGE_EXTENSION_NAME, VK_API_VERSION_1_2)
+VKEFH_DEVICE_EXTENSION_PROMOTED(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, VK_API_VERSION_1_2)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_buffer_device_address", VK_API_VERSION_1_2)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_timeline_semaphore", VK_API_VERSION_1_2)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_EXT_descriptor_indexing", VK_API_VERSION_1_2)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_spirv_1_4", VK_API_VERSION_1_2)
+VKEFH_DEVICE_EXTENSION_PROMOTED("VK_KHR_shader_float_controls", VK_API_VERSION_1_2)
+
+VKEFH_DEVICE_FEATURE_STRUCT(VkPhysicalDeviceMemoryPriorityFeaturesEXT, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT)
+VKEFH_DEVICE_FEATURE_STRUCT(VkPhysicalDevice8BitStorageFeatures, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_8BIT_STORAGE_FEATURES)
+VKEFH_DEVICE_FEATURE_STRUCT(VkPhysicalDeviceVulkan12Features, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES)
+VKEFH_DEVICE_FEATURE_STRUCT_REQUIRES(VkPhysicalDeviceMemoryPriorityFeaturesEXT, VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME, 0)
+VKEFH_DEVICE_FEATURE_STRUCT_REQUIRES(VkPhysicalDevice8BitStorageFeatures, VK_KHR_8BIT_STORAGE_EXTENSION_NAME, VK_API_VERSION_1_2)
+VKEFH_DEVICE_FEATURE_STRUCT_REQUIRES(VkPhysicalDeviceVulkan12Features, nullptr, VK_API_VERSION_1_2)
@@ -0,0 +1,176 @@
+#include "StubVulkan.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+std::vector<VkExtensionProperties> g_Extensions;
+std::vector<VkLayerProperties> g_Layers;
+
+/*
+Fills names of count items, each one of size VK_MAX_EXTENSION_NAME_SIZE, with stride bytes between them.
+Every n-th item gets one of declaredNames, so matching them is not helped by their position.
+Others get syntheticFormat with index of the item.
+*/
+void FillNames(char* firstName, size_t stride, uint32_t count,
+    const char* const* declaredNames, uint32_t declaredNameCount, const char* syntheticFormat)
+{
+    const uint32_t n = declaredNameCount > 0 && count > declaredNameCount ? count / declaredNameCount : 1;
+    uint32_t declaredNameIndex = 0;
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        char* const name = firstName + i * stride;
+        if(declaredNameIndex < declaredNameCount && i % n == 0)
+            strncpy(name, declaredNames[declaredNameIndex++], VK_MAX_EXTENSION_NAME_SIZE - 1);
+        else
+            snprintf(name, VK_MAX_EXTENSION_NAME_SIZE, syntheticFormat, i);
+    }
+}
+
+template<typename T>
+VkResult ReturnArray(const std::vector<T>& items, uint32_t* pCount, T* pItems)
+{
+    if(pItems == nullptr)
+    {
+        *pCount = (uint32_t)items.size();
+        return VK_SUCCESS;
+    }
+    const uint32_t count = *pCount < items.size() ? *pCount : (uint32_t)items.size();
+    if(count > 0)
+        memcpy(pItems, items.data(), count * sizeof(T));
+    *pCount = count;
+    return count < items.size() ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
+// Sets all VkBool32 members after sType and pNext. Trailing padding, if any, is overwritten too.
+template<typename T>
+void EnableAllFeatures(VkBaseOutStructure* s)
+{
+    VkBool32* const bools = (VkBool32*)(s + 1);
+    for(size_t i = 0, count = (sizeof(T) - sizeof(VkBaseOutStructure)) / sizeof(VkBool32); i < count; ++i)
+        bools[i] = VK_TRUE;
+}
+
+} // namespace
+
+namespace StubVulkan
+{
+
+void SetExtensions(uint32_t extensionCount, const char* const* declaredNames, uint32_t declaredNameCount)
+{
+    g_Extensions.assign(extensionCount, VkExtensionProperties{});
+    for(uint32_t i = 0; i < extensionCount; ++i)
+        g_Extensions[i].specVersion = 1;
+    if(extensionCount > 0)
+    {
+        FillNames(g_Extensions[0].extensionName, sizeof(VkExtensionProperties), extensionCount,
+            declaredNames, declaredNameCount, "VK_STUB_undeclared_extension_%u");
+    }
+}
+
+void SetLayers(uint32_t layerCount, const char* const* declaredNames, uint32_t declaredNameCount)
+{
+    g_Layers.assign(layerCount, VkLayerProperties{});
+    for(uint32_t i = 0; i < layerCount; ++i)
+    {
+        g_Layers[i].specVersion = VK_API_VERSION_1_2;
+        g_Layers[i].implementationVersion = 1;
+    }
+    if(layerCount > 0)
+    {
+        FillNames(g_Layers[0].layerName, sizeof(VkLayerProperties), layerCount,
+            declaredNames, declaredNameCount, "VK_LAYER_STUB_undeclared_%u");
+    }
+}
+
+} // namespace StubVulkan
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties(
+    const char* pLayerName, uint32_t* pPropertyCount, VkExtensionProperties* pProperties)
+{
+    (void)pLayerName;
+    return ReturnArray(g_Extensions, pPropertyCount, pProperties);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceLayerProperties(
+    uint32_t* pPropertyCount, VkLayerProperties* pProperties)
+{
+    return ReturnArray(g_Layers, pPropertyCount, pProperties);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties(
+    VkPhysicalDevice physicalDevice, const char* pLayerName, uint32_t* pPropertyCount, VkExtensionProperties* pProperties)
+{
+    (void)physicalDevice;
+    (void)pLayerName;
+    return ReturnArray(g_Extensions, pPropertyCount, pProperties);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFeatures2(
+    VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures2* pFeatures)
+{
+    (void)physicalDevice;
+    VkBool32* const coreFeatures = (VkBool32*)&pFeatures->features;
+    for(size_t i = 0; i < sizeof(VkPhysicalDeviceFeatures) / sizeof(VkBool32); ++i)
+        coreFeatures[i] = VK_TRUE;
+    // Only structures used in BenchExtensionsFeatures.inl are known. Others are left unchanged.
+    for(VkBaseOutStructure* s = (VkBaseOutStructure*)pFeatures->pNext; s != nullptr; s = s->pNext)
+    {
+        switch(s->sType)
+        {
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT:
+            EnableAllFeatures<VkPhysicalDeviceMemoryPriorityFeaturesEXT>(s);
+            break;
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_8BIT_STORAGE_FEATURES:
+            EnableAllFeatures<VkPhysicalDevice8BitStorageFeatures>(s);
+            break;
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES:
+            EnableAllFeatures<VkPhysicalDeviceVulkan12Features>(s);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceProperties2(
+    VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties2* pProperties)
+{
+    (void)physicalDevice;
+    VkPhysicalDeviceProperties& props = pProperties->properties;
+    props.apiVersion = VK_API_VERSION_1_2;
+    props.driverVersion = 1;
+    props.vendorID = 0x10000;
+    props.deviceID = 1;
+    strncpy(props.deviceName, "Stub device", VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties(
+    VkPhysicalDevice physicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties* pQueueFamilyProperties)
+{
+    (void)physicalDevice;
+    if(pQueueFamilyProperties == nullptr)
+    {
+        *pQueueFamilyPropertyCount = 1;
+        return;
+    }
+    if(*pQueueFamilyPropertyCount == 0)
+        return;
+    memset(pQueueFamilyProperties, 0, sizeof(VkQueueFamilyProperties));
+    pQueueFamilyProperties->queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+    pQueueFamilyProperties->queueCount = 1;
+    *pQueueFamilyPropertyCount = 1;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceSupportKHR(
+    VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, VkSurfaceKHR surface, VkBool32* pSupported)
+{
+    (void)physicalDevice;
+    (void)queueFamilyIndex;
+    (void)surface;
+    *pSupported = VK_TRUE;
+    return VK_SUCCESS;
+}
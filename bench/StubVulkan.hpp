@@ -0,0 +1,27 @@
+/*
+Stand-in for the Vulkan loader, so VkExtensionsFeaturesHelp can be benchmarked on a machine
+without a GPU. StubVulkan.cpp defines the global Vulkan functions called by the library, like
+vkEnumerateInstanceExtensionProperties, and the benchmark links with it instead of the loader.
+Instance and device extension enumeration both report the list set using SetExtensions, layer
+enumeration reports the list set using SetLayers. The physical device supports all features,
+reports Vulkan 1.2, and has a single queue family with graphics, compute, and transfer.
+*/
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace StubVulkan
+{
+
+/*
+Sets the list of extensions reported by enumeration to extensionCount items: declaredNames spread
+evenly among synthetic names that no definition file declares. If extensionCount is not greater
+than declaredNameCount, only first extensionCount of declaredNames are reported.
+Not thread-safe - call it only while nothing is enumerating.
+*/
+void SetExtensions(uint32_t extensionCount, const char* const* declaredNames, uint32_t declaredNameCount);
+
+// Like SetExtensions, for the list of layers reported by vkEnumerateInstanceLayerProperties.
+void SetLayers(uint32_t layerCount, const char* const* declaredNames, uint32_t declaredNameCount);
+
+} // namespace StubVulkan